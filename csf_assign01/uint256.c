@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include "uint256.h"
+#include "uint256_limb.h"
+#include "uint256_inline.h"
 
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
@@ -28,91 +30,239 @@ UInt256 uint256_create( const uint32_t data[8] ) {
   return result;
 }
 
+// Nibble value of each character, or HEX_INVALID for characters
+// that are not hex digits
+#define HEX_INVALID 0x10
+static const unsigned char hex_values[256] = {
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+  0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10
+};
+
+// Decode the len (<= 64) characters at hex straight into four limbs.
+// There are no data-dependent branches: each character costs one
+// table lookup. Returns a value with HEX_INVALID set if any of the
+// characters is not a hex digit, in which case w is meaningless;
+// callers that have already checked the digits can ignore it.
+static unsigned char hex_decode( uint64_t w[4], const char *hex, size_t len ) {
+  const unsigned char *p = (const unsigned char *) hex + len;
+  unsigned char bad = 0;
+  for (int i = 0; i < 4; i++) {
+    size_t n = len < 16 ? len : 16;
+    len -= n;
+    p -= n;
+    uint64_t limb = 0;
+    for (size_t k = 0; k < n; k++) {
+      unsigned char v = hex_values[p[k]];
+      bad |= v;
+      limb = (limb << 4) | (v & 0xf);
+    }
+    w[i] = limb;
+  }
+  return bad;
+}
+
 // Create a UInt256 value from a string of hexadecimal digits.
+// Digits are read up to the first character that is not a hex digit
+// (so "1234\n" gives 0x1234, like strtoul), and only the rightmost 64
+// of them are used (use uint256_parse_hex to reject bad input).
 UInt256 uint256_create_from_hex( const char *hex ) {
-  UInt256 result = {0};
-  size_t length = strlen(hex);
-  // char *start;
+  uint64_t w[4];
+  UInt256 result;
+  size_t length = strspn(hex, "0123456789abcdefABCDEF");
   //if length is over 64, only use the rightmost 64
   if (length > 64) {
     hex += length - 64;
     length = 64;
-  } 
-  //start at the last value
-  const char *position = hex + length - 1; 
-  int i = 0; 
-  while (length > 0) {
-    //get 8 bits so that it will never overflow
-    char eightBits[9] =  {0};
-    int size = 8;
-
-    if (length < 8) {
-      size = length;
-    }
-    for (int i = size - 1; i >= 0; i--) {
-      //go backwards for the values
-      eightBits[i] = *position;
-      position--;
+  }
+  //only hex digits are left, so nothing can be invalid
+  hex_decode(w, hex, length);
+  limbs_store(&result, w);
+  return result;
+}
+
+// Parse exactly len hex digits (upper or lower case, no prefix)
+// starting at hex, which need not be NUL-terminated. Stores the value
+// through result and returns UINT256_OK on success. Returns
+// UINT256_ERR_EMPTY if len is 0, UINT256_ERR_INVALID if any character
+// is not a hex digit, and UINT256_ERR_OVERFLOW if there are more than
+// 64 significant digits; *result is left unchanged on failure.
+UInt256Status uint256_parse_hex( const char *hex, size_t len, UInt256 *result ) {
+  uint64_t w[4];
+  unsigned char flags = 0;
+  if (len == 0) {
+    return UINT256_ERR_EMPTY;
+  }
+  //leading zeros beyond 64 digits don't change the value
+  while (len > 64 && *hex == '0') {
+    hex++;
+    len--;
+  }
+  if (len > 64) {
+    //still report a bad character ahead of the overflow
+    for (size_t i = 0; i < len; i++) {
+      flags |= hex_values[(unsigned char) hex[i]];
     }
-    //function to get the unsigned long value
-    result.data[i] = strtoul(eightBits, NULL, 16);
-    i++;
-    length -= size;
+    return (flags & HEX_INVALID) ? UINT256_ERR_INVALID : UINT256_ERR_OVERFLOW;
+  }
+  if (hex_decode(w, hex, len) & HEX_INVALID) {
+    return UINT256_ERR_INVALID;
   }
+  limbs_store(result, w);
+  return UINT256_OK;
+}
 
+// Lowercase hex digit for each nibble value
+static const char hex_digits[16] = {
+  '0', '1', '2', '3', '4', '5', '6', '7',
+  '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+};
 
-  return result;
+// Write the hex digits of val (no leading zeros, "0" for zero) and
+// a terminating NUL into buf, which has room for len chars.
+// Returns the number of digits written, or 0 (with buf set to ""
+// if len > 0) if buf is too small. UINT256_HEX_BUFSIZE is always
+// enough.
+size_t uint256_format_hex_into( UInt256 val, char *buf, size_t len ) {
+  uint64_t w[4];
+  limbs_load(w, &val);
+  //digit count straight from the bit length, no scan for the
+  //first nonzero nibble
+  int bits = limbs_bit_length(w, 4);
+  size_t ndigits = bits ? (size_t) (bits + 3) / 4 : 1;
+  if (len < ndigits + 1) {
+    if (len > 0) {
+      buf[0] = '\0';
+    }
+    return 0;
+  }
+
+  //fill from the least significant end, one table lookup per nibble
+  char *p = buf + ndigits;
+  *p = '\0';
+  size_t i = 0;
+  for (int limb = 0; i < ndigits; limb++) {
+    uint64_t v = w[limb];
+    for (int k = 0; k < 16 && i < ndigits; k++, i++) {
+      *--p = hex_digits[v & 0xf];
+      v >>= 4;
+    }
+  }
+  return ndigits;
 }
 
 // Return a dynamically-allocated string of hex digits representing the
 // given UInt256 value.
 char *uint256_format_as_hex( UInt256 val ) {
-  char *hex = malloc(sizeof(char) * 8 * 8 + 1);
+  char *hex = malloc(UINT256_HEX_BUFSIZE);
   if (!hex) {
     return NULL;
   }
-  hex[0] = '\0';
-  int endPoint = 0;
-  //find the highest endPoint that we must iterate to
-  for (int i = 7; i >= 0; i--) {
-    if (val.data[i] != 0 ) {
-      endPoint = i;
+  uint256_format_hex_into(val, hex, UINT256_HEX_BUFSIZE);
+  return hex;
+}
+
+// Largest power of ten that fits in a limb, and its digit count
+#define DEC_CHUNK 10000000000000000000ULL
+#define DEC_CHUNK_DIGITS 19
+
+// 10^k for 0 <= k <= 19
+static const uint64_t pow10_u64[DEC_CHUNK_DIGITS + 1] = {
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+  10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+  100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+  100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, DEC_CHUNK
+};
+
+// Create a UInt256 value from a string of decimal digits.
+// Parsing stops at the first character that is not a digit, and
+// values of 2^256 or more wrap around modulo 2^256.
+UInt256 uint256_create_from_dec( const char *dec ) {
+  uint64_t w[4] = {0, 0, 0, 0};
+  UInt256 result;
+  for (;;) {
+    //gather up to 19 digits into one limb...
+    uint64_t chunk = 0;
+    int ndigits = 0;
+    while (ndigits < DEC_CHUNK_DIGITS && *dec >= '0' && *dec <= '9') {
+      chunk = chunk * 10 + (uint64_t) (*dec++ - '0');
+      ndigits++;
+    }
+    if (ndigits == 0) {
+      break;
+    }
+    //...then fold it in with a single w = w*10^ndigits + chunk pass
+    uint64_t scale = pow10_u64[ndigits], carry = chunk;
+    for (int i = 0; i < 4; i++) {
+      w[i] = limb_mac(w[i], scale, 0, carry, &carry);
+    }
+    if (ndigits < DEC_CHUNK_DIGITS) {
       break;
     }
   }
-  //if the value is 0 or only 4 bits (i think this is an edge case)
-  if (endPoint == 0) {
-  if (val.data[0] == 0) {
-      strcpy(hex, "0"); // Copy "0" into the allocated memory
-      return hex;
-  }
-    char segment[9];
-    uint32_t newval = val.data[0];
-    sprintf(segment, "%x", newval);
-    strcat(hex, segment);
-    return hex;
-  }
-
+  limbs_store(&result, w);
+  return result;
+}
 
-    //handle endpoint without the leading 0's
-  char segment[9];
-  uint32_t newval = val.data[endPoint];
-  sprintf(segment, "%x", newval); // format with leading 0s
-  strcat(hex, segment);
+// Write the decimal digits of val (no leading zeros, "0" for zero)
+// and a terminating NUL into buf, which has room for len chars.
+// Returns the number of digits written, or 0 (with buf set to ""
+// if len > 0) if buf is too small. UINT256_DEC_BUFSIZE is always
+// enough.
+size_t uint256_format_dec_into( UInt256 val, char *buf, size_t len ) {
+  uint64_t w[4], chunks[5];
+  limbs_load(w, &val);
 
+  //peel off base-10^19 chunks, least significant first, dropping
+  //limbs from the dividend as they become zero
+  int nchunks = 0;
+  int n = limbs_used(w, 4);
+  do {
+    chunks[nchunks++] = limbs_divmod_1(w, w, n, DEC_CHUNK);
+    n = limbs_used(w, n);
+  } while (n > 0);
 
-  //iterate to everything but endpoint
-  for (int i = endPoint-1; i >= 0; i--) {
-      uint32_t newval = val.data[i];
-      char segment[9];
-      sprintf(segment, "%08x", newval); // format with leading 0s
-      strcat(hex, segment);
+  //only the most significant chunk is printed without zero padding
+  uint64_t top = chunks[nchunks - 1];
+  size_t top_digits = 1;
+  while (top_digits < DEC_CHUNK_DIGITS && top >= pow10_u64[top_digits]) {
+    top_digits++;
+  }
+  size_t ndigits = top_digits + (size_t) (nchunks - 1) * DEC_CHUNK_DIGITS;
+  if (len < ndigits + 1) {
+    if (len > 0) {
+      buf[0] = '\0';
+    }
+    return 0;
   }
-    return hex;
 
+  char *p = buf + ndigits;
+  *p = '\0';
+  for (int c = 0; c < nchunks; c++) {
+    uint64_t v = chunks[c];
+    size_t digits = c == nchunks - 1 ? top_digits : DEC_CHUNK_DIGITS;
+    for (size_t k = 0; k < digits; k++) {
+      *--p = (char) ('0' + v % 10);
+      v /= 10;
+    }
+  }
+  return ndigits;
 }
 
-
 // Get 32 bits of data from a UInt256 value.
 // Index 0 is the least significant 32 bits, index 7 is the most
 // significant 32 bits.
@@ -149,52 +299,309 @@ int uint256_is_bit_set( UInt256 val, unsigned index ) {
     return 0; 
 }
 
-// Compute the sum of two UInt256 values.
-UInt256 uint256_add( UInt256 left, UInt256 right ) {
-  uint32_t carry = 0;
-  UInt256 sum;
-  for (int i = 0; i < 8; i++) {
-    uint32_t leftval = left.data[i];
-    // uint32_t rightval = right.data[i];
-
-    //add the bitwise values and the carry from the previous uint32
-    sum.data[i] = left.data[i] + right.data[i] + carry;
-     //check if the sum exceeds the max value in that a uint32_t can store
-    if (sum.data[i] < leftval || (sum.data[i] == leftval && carry == 1)) {  
-    // the addition overflowed
-      carry = 1;
-    }
-    else {
-      carry = 0;
+// Return the number of significant bits in val (the index of the
+// highest set bit plus one), or 0 if val is zero.
+unsigned uint256_bit_length( UInt256 val ) {
+  uint64_t w[4];
+  limbs_load(w, &val);
+  return (unsigned) limbs_bit_length(w, 4);
+}
+
+// Return the number of leading zero bits in val (256 if val is zero).
+unsigned uint256_clz( UInt256 val ) {
+  return 256 - uint256_bit_length(val);
+}
+
+// Return the number of trailing zero bits in val (256 if val is zero).
+unsigned uint256_ctz( UInt256 val ) {
+  return uint256_next_set_bit(val, 0);
+}
+
+#ifdef UINT256_X86_INTRIN
+// popcnt is not in the x86-64 baseline, so the hardware version is
+// compiled for it separately and picked at run time, by a flag set
+// once at startup (see detect_cpu).
+static int have_popcnt;
+
+__attribute__((target("popcnt"))) static unsigned popcount_hw( const uint64_t w[4] ) {
+  return (unsigned) (__builtin_popcountll(w[0]) + __builtin_popcountll(w[1])
+                     + __builtin_popcountll(w[2]) + __builtin_popcountll(w[3]));
+}
+#endif
+
+// Return the number of set bits in val.
+unsigned uint256_popcount( UInt256 val ) {
+  uint64_t w[4];
+  limbs_load(w, &val);
+#ifdef UINT256_X86_INTRIN
+  if (have_popcnt) {
+    return popcount_hw(w);
+  }
+#endif
+  return (unsigned) (limb_popcount(w[0]) + limb_popcount(w[1])
+                     + limb_popcount(w[2]) + limb_popcount(w[3]));
+}
+
+// Return the index of the lowest set bit at or above index, or 256
+// if there is none.
+unsigned uint256_next_set_bit( UInt256 val, unsigned index ) {
+  if (index >= 256) {
+    return 256;
+  }
+  uint64_t w[4];
+  limbs_load(w, &val);
+  //mask off the bits below index in its limb, then skip whole
+  //zero limbs
+  unsigned i = index / 64;
+  uint64_t bits = w[i] & (~(uint64_t) 0 << (index % 64));
+  while (bits == 0) {
+    if (++i == 4) {
+      return 256;
     }
-    
+    bits = w[i];
   }
+  return i * 64 + (unsigned) limb_ctz(bits);
+}
 
+// Knuth's Algorithm D (TAOCP vol. 2, 4.3.1) on 64-bit limbs.
+// Divides the m-limb u by the n-limb v, where 2 <= n <= 4,
+// n <= m <= DIV_MAX_LIMBS and v[n-1] != 0. Writes m-n+1 quotient
+// limbs to q and n remainder limbs to r.
+static void limbs_divmod_knuth( uint64_t *q, uint64_t *r, const uint64_t *u, int m, const uint64_t *v, int n ) {
+  uint64_t un[DIV_MAX_LIMBS + 1], vn[4];
 
-  return sum;
+  //normalize so the divisor's top bit is set, which keeps every
+  //trial quotient within 2 of the true quotient limb
+  int s = limb_clz(v[n - 1]);
+  for (int i = n - 1; i > 0; i--) {
+    vn[i] = (v[i] << s) | (s ? v[i - 1] >> (64 - s) : 0);
+  }
+  vn[0] = v[0] << s;
+  un[m] = s ? u[m - 1] >> (64 - s) : 0;
+  for (int i = m - 1; i > 0; i--) {
+    un[i] = (u[i] << s) | (s ? u[i - 1] >> (64 - s) : 0);
+  }
+  un[0] = u[0] << s;
+
+  for (int j = m - n; j >= 0; j--) {
+    //estimate the quotient limb from the top two dividend limbs
+    uint64_t qhat, rhat;
+    int rhat_overflow = 0;
+    if (un[j + n] >= vn[n - 1]) {
+      qhat = ~(uint64_t) 0;
+      rhat = un[j + n - 1] + vn[n - 1];
+      rhat_overflow = rhat < vn[n - 1];
+    } else {
+      qhat = limb_div(un[j + n], un[j + n - 1], vn[n - 1], &rhat);
+    }
+    //refine it with the second divisor limb
+    while (!rhat_overflow) {
+      uint64_t phi, plo = limb_mul(qhat, vn[n - 2], &phi);
+      if (phi < rhat || (phi == rhat && plo <= un[j + n - 2])) {
+        break;
+      }
+      qhat--;
+      rhat += vn[n - 1];
+      rhat_overflow = rhat < vn[n - 1];
+    }
+
+    //multiply and subtract qhat * vn from the current window
+    uint64_t mulcarry = 0;
+    unsigned char borrow = 0;
+    for (int i = 0; i < n; i++) {
+      uint64_t phi, plo = limb_mul(qhat, vn[i], &phi);
+      plo += mulcarry;
+      phi += plo < mulcarry;
+      un[i + j] = limb_subb(un[i + j], plo, borrow, &borrow);
+      mulcarry = phi;
+    }
+    un[j + n] = limb_subb(un[j + n], mulcarry, borrow, &borrow);
+
+    //qhat was still one too large (rare), add the divisor back
+    if (borrow) {
+      unsigned char carry = 0;
+      qhat--;
+      for (int i = 0; i < n; i++) {
+        un[i + j] = limb_addc(un[i + j], vn[i], carry, &carry);
+      }
+      un[j + n] += carry;
+    }
+    q[j] = qhat;
+  }
+
+  //the remainder is what is left of the dividend, shifted back
+  for (int i = 0; i < n - 1; i++) {
+    r[i] = (un[i] >> s) | (s ? un[i + 1] << (64 - s) : 0);
+  }
+  r[n - 1] = un[n - 1] >> s;
 }
 
+// Divide the m-limb u by the 4-limb v (nonzero), writing m quotient
+// limbs to q and 4 remainder limbs to r. Picks the single-limb or
+// multi-limb path based on the divisor's length.
+void limbs_divmod( uint64_t *q, uint64_t r[4], const uint64_t *u, int m, const uint64_t v[4] ) {
+  int n = limbs_used(v, 4);
+  int um = limbs_used(u, m);
+  assert(n > 0);
+  for (int i = 0; i < m; i++) {
+    q[i] = 0;
+  }
+  r[0] = r[1] = r[2] = r[3] = 0;
+  if (n == 1) {
+    r[0] = limbs_divmod_1(q, u, um, v[0]);
+  } else if (um < n) {
+    for (int i = 0; i < um; i++) {
+      r[i] = u[i];
+    }
+  } else {
+    limbs_divmod_knuth(q, r, u, um, v, n);
+  }
+}
 
+// Compute the sum of two UInt256 values.
+UInt256 uint256_add( UInt256 left, UInt256 right ) {
+  UInt256 sum;
+  uint256_add_inline(&sum, &left, &right);
+  return sum;
+}
 
 // Compute the difference of two UInt256 values.
 UInt256 uint256_sub( UInt256 left, UInt256 right ) {
-  //computing result = a - b = a + -b
-  UInt256 result = uint256_add(left, uint256_negate(right));
+  UInt256 result;
+  uint256_sub_inline(&result, &left, &right);
   return result;
 }
 
 // Return the two's-complement negation of the given UInt256 value.
 UInt256 uint256_negate( UInt256 val ) {
   UInt256 result;
-  UInt256 one = uint256_create_from_u32(1);
+  uint256_negate_inline(&result, &val);
+  return result;
+}
+
+// Compute *a + *b into dst (e.g. uint256_add_to( &acc, &acc, &x )
+// accumulates into acc).
+void uint256_add_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint256_add_inline(dst, a, b);
+}
+
+// Compute *a - *b into dst.
+void uint256_sub_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint256_sub_inline(dst, a, b);
+}
+
+// Compute the two's complement negation of *a into dst.
+void uint256_negate_to( UInt256 *dst, const UInt256 *a ) {
+  uint256_negate_inline(dst, a);
+}
+
+// Checked arithmetic: store the wrapped result through result and
+// return the carry, borrow or overflow flag from the same pass.
+// uint256_add_carry returns 1 if left + right >= 2^256,
+// uint256_sub_borrow 1 if left < right, and uint256_mul_checked 1
+// if the product does not fit in 256 bits.
+int uint256_add_carry( UInt256 left, UInt256 right, UInt256 *result ) {
+  uint64_t a[4], b[4], s[4];
+  unsigned char carry = 0;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  //written out so the chain stays in the flags, as in uint256_add
+  s[0] = limb_addc(a[0], b[0], carry, &carry);
+  s[1] = limb_addc(a[1], b[1], carry, &carry);
+  s[2] = limb_addc(a[2], b[2], carry, &carry);
+  s[3] = limb_addc(a[3], b[3], carry, &carry);
+  limbs_store(result, s);
+  return carry;
+}
+
+int uint256_sub_borrow( UInt256 left, UInt256 right, UInt256 *result ) {
+  uint64_t a[4], b[4], d[4];
+  unsigned char borrow = 0;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  d[0] = limb_subb(a[0], b[0], borrow, &borrow);
+  d[1] = limb_subb(a[1], b[1], borrow, &borrow);
+  d[2] = limb_subb(a[2], b[2], borrow, &borrow);
+  d[3] = limb_subb(a[3], b[3], borrow, &borrow);
+  limbs_store(result, d);
+  return borrow;
+}
+
+int uint256_mul_checked( UInt256 left, UInt256 right, UInt256 *result ) {
+  uint64_t a[4], b[4], p[8];
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  //as in uint256_mul_overflows, the limb counts settle the flag
+  //except when they add up to five, and only then is the high half
+  //of the product needed
+  int used = limbs_used(a, 4) + limbs_used(b, 4);
+  if (used != 5) {
+    limbs_mul_lo_dispatch(p, a, b);
+    limbs_store(result, p);
+    return used > 5;
+  }
+  limbs_mul_wide_dispatch(p, a, b);
+  limbs_store(result, p);
+  return (p[4] | p[5] | p[6] | p[7]) != 0;
+}
+
+// Saturating arithmetic: results that do not fit are clamped to
+// 2^256 - 1 (sums and products) or 0 (differences).
+UInt256 uint256_add_sat( UInt256 left, UInt256 right ) {
+  UInt256 sum;
+  uint32_t mask = (uint32_t) 0 - (uint32_t) uint256_add_carry(left, right, &sum);
+  for (int i = 0; i < 8; i++) {
+    sum.data[i] |= mask;
+  }
+  return sum;
+}
 
-  //make result negation of val
+UInt256 uint256_sub_sat( UInt256 left, UInt256 right ) {
+  UInt256 diff;
+  uint32_t mask = (uint32_t) 0 - (uint32_t) uint256_sub_borrow(left, right, &diff);
   for (int i = 0; i < 8; i++) {
-    result.data[i] = ~val.data[i];
+    diff.data[i] &= ~mask;
+  }
+  return diff;
+}
+
+UInt256 uint256_mul_sat( UInt256 left, UInt256 right ) {
+  UInt256 product;
+  uint32_t mask = (uint32_t) 0 - (uint32_t) uint256_mul_checked(left, right, &product);
+  for (int i = 0; i < 8; i++) {
+    product.data[i] |= mask;
+  }
+  return product;
+}
+
+// Add a single word to val. The carry stops propagating at the
+// first limb that doesn't wrap, which for most values is the first.
+UInt256 uint256_add_u64( UInt256 val, uint64_t word ) {
+  uint64_t w[4];
+  unsigned char carry;
+  UInt256 result;
+  limbs_load(w, &val);
+  w[0] = limb_addc(w[0], word, 0, &carry);
+  //spelled out rather than looped so w stays in registers
+  if (carry && ++w[1] == 0 && ++w[2] == 0) {
+    ++w[3];
   }
-  //add 1 to result
-  result = uint256_add(result, one);
+  limbs_store(&result, w);
+  return result;
+}
 
+// Multiply val by a single word (the low 256 bits of the product).
+UInt256 uint256_mul_u64( UInt256 val, uint64_t word ) {
+  uint64_t w[4], p[4], c = 0;
+  UInt256 result;
+  limbs_load(w, &val);
+  //one row of the schoolbook product; the carry out of the top
+  //limb is the part that gets truncated
+  p[0] = limb_mac(w[0], word, 0, c, &c);
+  p[1] = limb_mac(w[1], word, 0, c, &c);
+  p[2] = limb_mac(w[2], word, 0, c, &c);
+  p[3] = w[3] * word + c;
+  limbs_store(&result, p);
   return result;
 }
 
@@ -208,51 +615,383 @@ void uint256_print(UInt256 val) {
   printf("\n");
 }
 
+#ifdef UINT256_X86_INTRIN
+int limbs_have_adx;
+
+// The MULX/ADX kernels and the popcnt version of uint256_popcount are
+// chosen once at startup, so the hot paths only test a flag.
+__attribute__((constructor)) static void detect_cpu( void ) {
+  __builtin_cpu_init();
+  limbs_have_adx = __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx");
+  have_popcnt = __builtin_cpu_supports("popcnt");
+}
+#endif
+
+// Select the multiply kernels: with enable nonzero, products and
+// Montgomery products use the MULX/ADX code on CPUs that have it
+// (the default), otherwise the portable limb code. Returns 1 if the
+// MULX/ADX kernels are in use afterwards. Results are the same
+// either way; this is for testing and benchmarking. Not thread-safe
+// with respect to concurrent multiplies.
+int uint256_use_adx( int enable ) {
+#ifdef UINT256_X86_INTRIN
+  detect_cpu();
+  limbs_have_adx = limbs_have_adx && enable;
+  return limbs_have_adx;
+#else
+  (void) enable;
+  return 0;
+#endif
+}
+
 // Compute the product of two UInt256 values.
 UInt256 uint256_mul( UInt256 left, UInt256 right ) {
-  UInt256 product = uint256_create_from_u32(0);
-  //store bit-wise product
-  UInt256 term = uint256_create_from_u32(0);
-  for (int index = 0; index < 8; index++){
-    for (int bitindex = 0; bitindex < 32; bitindex++){
-      if((right.data[index] & (1u << bitindex)) == (1u << bitindex)){
-        //if nth bit is 1, multiply left value by 2^n
-        term = uint256_lshift(left, index*32 + bitindex);
-        product = uint256_add(product, term);
-      }
+  uint64_t a[4], b[4], p[4];
+  UInt256 product;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  limbs_mul_lo_dispatch(p, a, b);
+  limbs_store(&product, p);
+  return product;
+}
+
+// Compute the square of a UInt256 value.
+UInt256 uint256_sqr( UInt256 val ) {
+  uint64_t a[4], p[4];
+  UInt256 square;
+  limbs_load(a, &val);
+  limbs_sqr_lo(p, a);
+  limbs_store(&square, p);
+  return square;
+}
+
+// Compute the low 256 bits of *a * *b into dst.
+void uint256_mul_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint64_t x[4], y[4], p[4];
+  limbs_load(x, a);
+  limbs_load(y, b);
+  limbs_mul_lo_dispatch(p, x, y);
+  limbs_store(dst, p);
+}
+
+// Compute the low 256 bits of *a squared into dst.
+void uint256_sqr_to( UInt256 *dst, const UInt256 *a ) {
+  uint64_t x[4], p[4];
+  limbs_load(x, a);
+  limbs_sqr_lo(p, x);
+  limbs_store(dst, p);
+}
+
+// Compute the full 512-bit product of two UInt256 values.
+UInt512 uint256_mul_wide( UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], p[8];
+  UInt512 product;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  limbs_mul_wide_dispatch(p, a, b);
+  wide_store(&product, p);
+  return product;
+}
+
+// Return 1 if the product of two UInt256 values does not fit in
+// 256 bits (i.e., uint256_mul would truncate it), 0 otherwise.
+int uint256_mul_overflows( UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], p[8];
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  //a product of an m-limb and an n-limb value has m+n-1 or m+n
+  //limbs, so only the m+n == 5 case needs the high half computed
+  int used = limbs_used(a, 4) + limbs_used(b, 4);
+  if (used <= 4) {
+    return 0;
+  }
+  if (used >= 6) {
+    return 1;
+  }
+  limbs_mul_wide_dispatch(p, a, b);
+  return (p[4] | p[5] | p[6] | p[7]) != 0;
+}
+
+// Compare two UInt256 values. Returns a negative value if left < right,
+// 0 if they are equal, and a positive value if left > right.
+int uint256_cmp( UInt256 left, UInt256 right ) {
+  return uint256_cmp_inline(&left, &right);
+}
+
+// Compare a UInt256 value against a single word, with the same
+// result convention as uint256_cmp.
+int uint256_cmp_u64( UInt256 left, uint64_t right ) {
+  uint64_t w[4];
+  limbs_load(w, &left);
+  if (w[1] | w[2] | w[3]) {
+    return 1;
+  }
+  return w[0] < right ? -1 : w[0] > right;
+}
+
+// Divide num by den (which must be nonzero), returning the quotient.
+// If rem is non-NULL, the remainder is stored there.
+UInt256 uint256_divmod( UInt256 num, UInt256 den, UInt256 *rem ) {
+  uint64_t u[4], v[4], q[4], r[4];
+  UInt256 quotient;
+  limbs_load(u, &num);
+  limbs_load(v, &den);
+  limbs_divmod(q, r, u, 4, v);
+  limbs_store(&quotient, q);
+  if (rem) {
+    limbs_store(rem, r);
+  }
+  return quotient;
+}
+
+// Compute the quotient of two UInt256 values (right must be nonzero).
+UInt256 uint256_div( UInt256 left, UInt256 right ) {
+  return uint256_divmod(left, right, NULL);
+}
+
+// Compute the remainder of dividing left by right (right must be
+// nonzero).
+UInt256 uint256_mod( UInt256 left, UInt256 right ) {
+  UInt256 rem;
+  uint256_divmod(left, right, &rem);
+  return rem;
+}
+
+// Divide num by the single word den (which must be nonzero),
+// returning the quotient. If rem is non-NULL, the remainder is
+// stored there.
+UInt256 uint256_divmod_u64( UInt256 num, uint64_t den, uint64_t *rem ) {
+  uint64_t u[4], q[4];
+  UInt256 quotient;
+  assert(den != 0);
+  limbs_load(u, &num);
+  uint64_t r = limbs_divmod_1(q, u, 4, den);
+  limbs_store(&quotient, q);
+  if (rem) {
+    *rem = r;
+  }
+  return quotient;
+}
+
+// Compute num mod den for a 512-bit num (den must be nonzero).
+UInt256 uint512_mod( UInt512 num, UInt256 den ) {
+  uint64_t u[8], v[4], q[8], r[4];
+  UInt256 rem;
+  wide_load(u, &num);
+  limbs_load(v, &den);
+  limbs_divmod(q, r, u, 8, v);
+  limbs_store(&rem, r);
+  return rem;
+}
+
+// Return the greatest common divisor of left and right, with
+// gcd( x, 0 ) == gcd( 0, x ) == x.
+UInt256 uint256_gcd( UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], na[4];
+  UInt256 result;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  int za = limbs_ctz(a, 4), zb = limbs_ctz(b, 4);
+  if (za == 256) {
+    return right;
+  }
+  if (zb == 256) {
+    return left;
+  }
+
+  //take out the common power of two, which leaves b odd as the
+  //batched binary GCD needs. It then drives a to 0 and leaves the
+  //odd part of the gcd in b.
+  int k = za < zb ? za : zb;
+  limbs_shr(b, b, 4, zb);
+  while (a[0] | a[1] | a[2] | a[3]) {
+    GcdMatrix mat = gcd_steps(a, b);
+    gcd_apply(na, a, mat.f0, b, mat.g0);
+    gcd_apply(b, a, mat.f1, b, mat.g1);
+    memcpy(a, na, sizeof(a));
+  }
+  limbs_shl(b, b, 4, k);
+  limbs_store(&result, b);
+  return result;
+}
+
+// Integer square root of a single limb, by Newton's method from a
+// power of two above the root. The iterates decrease to the root and
+// stop as soon as they would go back up.
+static uint64_t limb_isqrt( uint64_t x ) {
+  if (x < 2) {
+    return x;
+  }
+  uint64_t r = (uint64_t) 1 << ((65 - limb_clz(x)) / 2);
+  for (;;) {
+    uint64_t y = (r + x / r) / 2;
+    if (y >= r) {
+      return r;
     }
+    r = y;
   }
-  return product;
 }
 
-UInt256 uint256_lshift( UInt256 val, unsigned shift ) {
-  assert( shift < 256 );
-  unsigned indexshift = shift / 32;
-  unsigned bitshift = shift % 32;
-  uint32_t left;
-  uint32_t right;
-  UInt256 temp = uint256_create_from_u32(0);
-  UInt256 result = uint256_create_from_u32(0);
-  for (int i = 7; i >= 0; i--) {
-    //separate left and right side of current element
-    right = val.data[i] << bitshift;
-    if (bitshift > 0) {
-      left = val.data[i] >> (32 - bitshift);
-    }else{
-      //shift 32 leading to undefined behavior
-      left = 0;
+// Return the integer square root of val, the largest r with
+// r*r <= val.
+UInt256 uint256_isqrt( UInt256 val ) {
+  uint64_t n[4], x[4] = {0, 0, 0, 0}, q[4], rem[4], y[4];
+  UInt256 result;
+  limbs_load(n, &val);
+  int bits = limbs_bit_length(n, 4);
+  if (bits <= 64) {
+    x[0] = limb_isqrt(n[0]);
+    limbs_store(&result, x);
+    return result;
+  }
+
+  //start from the root of the top 63 or 64 bits (shifted by an even
+  //amount, so the root shifts by half), rounded up so the start is
+  //above the true root. It is already good to 32 bits, so Newton
+  //needs about three full-width divisions to finish.
+  int shift = (bits - 63) & ~1;
+  limbs_shr(x, n, 4, shift);
+  x[0] = limb_isqrt(x[0]) + 1;
+  x[1] = x[2] = x[3] = 0;
+  limbs_shl(x, x, 4, shift / 2);
+  for (;;) {
+    //y = (x + n/x) / 2; both terms are below 2^129, so no overflow
+    unsigned char carry = 0, borrow = 0;
+    limbs_divmod(q, rem, n, 4, x);
+    for (int i = 0; i < 4; i++) {
+      y[i] = limb_addc(x[i], q[i], carry, &carry);
     }
-    if (i + indexshift < 8) {
-      //assign right part to appropriate index
-      temp.data[i + indexshift] = right;
+    limbs_shr(y, y, 4, 1);
+    for (int i = 0; i < 4; i++) {
+      limb_subb(y[i], x[i], borrow, &borrow);
     }
-    if (i + indexshift + 1 < 8) {
-      //assign left part to appropriate index
-      temp.data[i + indexshift + 1] = left;
+    if (!borrow) {
+      break;
     }
-    //store current index's shifted value to result, then reset temp
-    result = uint256_add(result, temp);
-    temp = uint256_create_from_u32(0);
+    memcpy(x, y, sizeof(x));
   }
+  limbs_store(&result, x);
+  return result;
+}
+
+// Return the least significant 256 bits of a UInt512 value.
+UInt256 uint512_lo( UInt512 val ) {
+  return uint256_create(&val.data[0]);
+}
+
+// Return the most significant 256 bits of a UInt512 value.
+UInt256 uint512_hi( UInt512 val ) {
+  return uint256_create(&val.data[8]);
+}
+
+// Shift given UInt256 value left by specified number of bits
+// (shift must be less than 256).
+UInt256 uint256_lshift( UInt256 val, unsigned shift ) {
+  assert( shift < 256 );
+  uint64_t w[4];
+  UInt256 result;
+  limbs_load(w, &val);
+  limbs_shl(w, w, 4, (int) shift);
+  limbs_store(&result, w);
   return result;
 }
+
+// Compute val >> shift (shift must be less than 256).
+UInt256 uint256_rshift( UInt256 val, unsigned shift ) {
+  assert( shift < 256 );
+  uint64_t w[4];
+  UInt256 result;
+  limbs_load(w, &val);
+  limbs_shr(w, w, 4, (int) shift);
+  limbs_store(&result, w);
+  return result;
+}
+
+// Compute *a shifted left by shift bits into dst (shift must be
+// less than 256).
+void uint256_lshift_to( UInt256 *dst, const UInt256 *a, unsigned shift ) {
+  assert( shift < 256 );
+  uint64_t w[4];
+  limbs_load(w, a);
+  limbs_shl(w, w, 4, (int) shift);
+  limbs_store(dst, w);
+}
+
+// Compute *a shifted right by shift bits into dst (shift must be
+// less than 256).
+void uint256_rshift_to( UInt256 *dst, const UInt256 *a, unsigned shift ) {
+  assert( shift < 256 );
+  uint64_t w[4];
+  limbs_load(w, a);
+  limbs_shr(w, w, 4, (int) shift);
+  limbs_store(dst, w);
+}
+
+// Rotate val left by shift bits (any shift, taken modulo 256).
+UInt256 uint256_rotl( UInt256 val, unsigned shift ) {
+  uint64_t w[4], hi[4], lo[4];
+  UInt256 result;
+  shift %= 256;
+  limbs_load(w, &val);
+  //a shift of 256 clears everything, so shift == 0 needs no branch
+  limbs_shl(hi, w, 4, (int) shift);
+  limbs_shr(lo, w, 4, (int) (256 - shift));
+  for (int i = 0; i < 4; i++) {
+    w[i] = hi[i] | lo[i];
+  }
+  limbs_store(&result, w);
+  return result;
+}
+
+// Rotate val right by shift bits (any shift, taken modulo 256).
+UInt256 uint256_rotr( UInt256 val, unsigned shift ) {
+  return uint256_rotl(val, (256 - shift % 256) % 256);
+}
+
+// Compute the bitwise AND of two UInt256 values.
+UInt256 uint256_and( UInt256 left, UInt256 right ) {
+  UInt256 result;
+  uint256_and_inline(&result, &left, &right);
+  return result;
+}
+
+// Compute the bitwise OR of two UInt256 values.
+UInt256 uint256_or( UInt256 left, UInt256 right ) {
+  UInt256 result;
+  uint256_or_inline(&result, &left, &right);
+  return result;
+}
+
+// Compute the bitwise XOR of two UInt256 values.
+UInt256 uint256_xor( UInt256 left, UInt256 right ) {
+  UInt256 result;
+  uint256_xor_inline(&result, &left, &right);
+  return result;
+}
+
+// Compute the bitwise complement of a UInt256 value.
+UInt256 uint256_not( UInt256 val ) {
+  UInt256 result;
+  uint256_not_inline(&result, &val);
+  return result;
+}
+
+// Compute the bitwise AND of *a and *b into dst.
+void uint256_and_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint256_and_inline(dst, a, b);
+}
+
+// Compute the bitwise OR of *a and *b into dst.
+void uint256_or_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint256_or_inline(dst, a, b);
+}
+
+// Compute the bitwise XOR of *a and *b into dst.
+void uint256_xor_to( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint256_xor_inline(dst, a, b);
+}
+
+// Compute the bitwise complement of *a into dst.
+void uint256_not_to( UInt256 *dst, const UInt256 *a ) {
+  uint256_not_inline(dst, a);
+}
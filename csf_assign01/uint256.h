@@ -1,8 +1,21 @@
 #ifndef UINT256_H
 #define UINT256_H
 
+#include <stddef.h>
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Buffer size that always holds a formatted UInt256 hex string
+// (64 digits plus the terminating NUL).
+#define UINT256_HEX_BUFSIZE 65
+
+// Buffer size that always holds a formatted UInt256 decimal string
+// (2^256 - 1 has 78 digits, plus the terminating NUL).
+#define UINT256_DEC_BUFSIZE 79
+
 // Data type representing a 256-bit unsigned integer, represented
 // as an array of 8 uint32_t values. It is expected that the value
 // at index 0 is the least significant, and the value at index 7
@@ -14,6 +27,22 @@ typedef struct {
   uint32_t data[8];
 } UInt256;
 
+// Data type representing a 512-bit unsigned integer, used to hold
+// full-width products of UInt256 values. Same layout as UInt256:
+// index 0 is the least significant word, index 15 the most
+// significant.
+typedef struct {
+  uint32_t data[16];
+} UInt512;
+
+// Status codes returned by the checked parsers.
+typedef enum {
+  UINT256_OK = 0,
+  UINT256_ERR_EMPTY,     // no digits
+  UINT256_ERR_INVALID,   // a character is not a valid digit
+  UINT256_ERR_OVERFLOW,  // the value does not fit in 256 bits
+} UInt256Status;
+
 // Create a UInt256 value from a single uint32_t value.
 // Only the least-significant 32 bits are initialized directly,
 // all other bits are set to 0.
@@ -25,12 +54,43 @@ UInt256 uint256_create_from_u32( uint32_t val );
 UInt256 uint256_create( const uint32_t data[8] );
 
 // Create a UInt256 value from a string of hexadecimal digits.
+// Digits are read up to the first character that is not a hex digit
+// (so "1234\n" gives 0x1234, like strtoul), and only the rightmost 64
+// of them are used (use uint256_parse_hex to reject bad input).
 UInt256 uint256_create_from_hex( const char *hex );
 
+// Parse exactly len hex digits (upper or lower case, no prefix)
+// starting at hex, which need not be NUL-terminated. Stores the value
+// through result and returns UINT256_OK on success. Returns
+// UINT256_ERR_EMPTY if len is 0, UINT256_ERR_INVALID if any character
+// is not a hex digit, and UINT256_ERR_OVERFLOW if there are more than
+// 64 significant digits; *result is left unchanged on failure.
+// Does not allocate.
+UInt256Status uint256_parse_hex( const char *hex, size_t len, UInt256 *result );
+
 // Return a dynamically-allocated string of hex digits representing the
 // given UInt256 value.
 char *uint256_format_as_hex( UInt256 val );
 
+// Write the hex digits of val (no leading zeros, "0" for zero) and
+// a terminating NUL into buf, which has room for len chars.
+// Returns the number of digits written, or 0 (with buf set to ""
+// if len > 0) if buf is too small. UINT256_HEX_BUFSIZE is always
+// enough. Does not allocate.
+size_t uint256_format_hex_into( UInt256 val, char *buf, size_t len );
+
+// Create a UInt256 value from a string of decimal digits.
+// Parsing stops at the first character that is not a digit, and
+// values of 2^256 or more wrap around modulo 2^256.
+UInt256 uint256_create_from_dec( const char *dec );
+
+// Write the decimal digits of val (no leading zeros, "0" for zero)
+// and a terminating NUL into buf, which has room for len chars.
+// Returns the number of digits written, or 0 (with buf set to ""
+// if len > 0) if buf is too small. UINT256_DEC_BUFSIZE is always
+// enough. Does not allocate.
+size_t uint256_format_dec_into( UInt256 val, char *buf, size_t len );
+
 // Get 32 bits of data from a UInt256 value.
 // Index 0 is the least significant 32 bits, index 7 is the most
 // significant 32 bits.
@@ -39,6 +99,25 @@ uint32_t uint256_get_bits( UInt256 val, unsigned index );
 // Return 1 if bit at given index is set, 0 otherwise.
 int uint256_is_bit_set( UInt256 val, unsigned index );
 
+// Return the number of significant bits in val (the index of the
+// highest set bit plus one), or 0 if val is zero.
+unsigned uint256_bit_length( UInt256 val );
+
+// Return the number of leading zero bits in val (256 if val is zero).
+unsigned uint256_clz( UInt256 val );
+
+// Return the number of trailing zero bits in val (256 if val is zero).
+unsigned uint256_ctz( UInt256 val );
+
+// Return the number of set bits in val.
+unsigned uint256_popcount( UInt256 val );
+
+// Return the index of the lowest set bit at or above index, or 256
+// if there is none. Walking the set bits of val:
+//   for ( i = uint256_next_set_bit( val, 0 ); i < 256;
+//         i = uint256_next_set_bit( val, i + 1 ) )
+unsigned uint256_next_set_bit( UInt256 val, unsigned index );
+
 // Compute the sum of two UInt256 values.
 UInt256 uint256_add( UInt256 left, UInt256 right );
 
@@ -48,12 +127,162 @@ UInt256 uint256_sub( UInt256 left, UInt256 right );
 // Return the two's-complement negation of the given UInt256 value.
 UInt256 uint256_negate( UInt256 val );
 
+// Checked arithmetic: store the wrapped result through result and
+// return the carry, borrow or overflow flag from the same pass.
+// uint256_add_carry returns 1 if left + right >= 2^256,
+// uint256_sub_borrow 1 if left < right, and uint256_mul_checked 1
+// if the product does not fit in 256 bits.
+int uint256_add_carry( UInt256 left, UInt256 right, UInt256 *result );
+int uint256_sub_borrow( UInt256 left, UInt256 right, UInt256 *result );
+int uint256_mul_checked( UInt256 left, UInt256 right, UInt256 *result );
+
+// Saturating arithmetic: results that do not fit are clamped to
+// 2^256 - 1 (sums and products) or 0 (differences).
+UInt256 uint256_add_sat( UInt256 left, UInt256 right );
+UInt256 uint256_sub_sat( UInt256 left, UInt256 right );
+UInt256 uint256_mul_sat( UInt256 left, UInt256 right );
+
+// Add a single word to val. The carry stops propagating at the
+// first limb that doesn't wrap, which for most values is the first.
+UInt256 uint256_add_u64( UInt256 val, uint64_t word );
+
+// Multiply val by a single word (the low 256 bits of the product).
+UInt256 uint256_mul_u64( UInt256 val, uint64_t word );
+
 void uint256_print( UInt256 val );
 
+// Select the multiply kernels: with enable nonzero, products and
+// Montgomery products use the MULX/ADX code on CPUs that have it
+// (the default), otherwise the portable limb code. Returns 1 if the
+// MULX/ADX kernels are in use afterwards. Results are the same
+// either way; this is for testing and benchmarking. Not thread-safe
+// with respect to concurrent multiplies.
+int uint256_use_adx( int enable );
+
 // Compute the product of two UInt256 values.
 UInt256 uint256_mul( UInt256 left, UInt256 right );
 
-// Shift given UInt256 value left by specified number of bits.
+// Compute the square of a UInt256 value. Same result as
+// uint256_mul( val, val ), but cheaper.
+UInt256 uint256_sqr( UInt256 val );
+
+// Compute the full 512-bit product of two UInt256 values.
+UInt512 uint256_mul_wide( UInt256 left, UInt256 right );
+
+// Return 1 if the product of two UInt256 values does not fit in
+// 256 bits (i.e., uint256_mul would truncate it), 0 otherwise.
+int uint256_mul_overflows( UInt256 left, UInt256 right );
+
+// Compare two UInt256 values. Returns a negative value if left < right,
+// 0 if they are equal, and a positive value if left > right.
+int uint256_cmp( UInt256 left, UInt256 right );
+
+// Compare a UInt256 value against a single word, with the same
+// result convention as uint256_cmp.
+int uint256_cmp_u64( UInt256 left, uint64_t right );
+
+// Divide num by den (which must be nonzero), returning the quotient.
+// If rem is non-NULL, the remainder is stored there.
+UInt256 uint256_divmod( UInt256 num, UInt256 den, UInt256 *rem );
+
+// Compute the quotient of two UInt256 values (right must be nonzero).
+UInt256 uint256_div( UInt256 left, UInt256 right );
+
+// Compute the remainder of dividing left by right (right must be
+// nonzero).
+UInt256 uint256_mod( UInt256 left, UInt256 right );
+
+// Divide num by the single word den (which must be nonzero),
+// returning the quotient. If rem is non-NULL, the remainder is
+// stored there.
+UInt256 uint256_divmod_u64( UInt256 num, uint64_t den, uint64_t *rem );
+
+// Compute num mod den for a 512-bit num (den must be nonzero).
+UInt256 uint512_mod( UInt512 num, UInt256 den );
+
+// Return the greatest common divisor of left and right, with
+// gcd( x, 0 ) == gcd( 0, x ) == x.
+UInt256 uint256_gcd( UInt256 left, UInt256 right );
+
+// Return the integer square root of val, the largest r with
+// r*r <= val.
+UInt256 uint256_isqrt( UInt256 val );
+
+// Return the least significant 256 bits of a UInt512 value.
+UInt256 uint512_lo( UInt512 val );
+
+// Return the most significant 256 bits of a UInt512 value.
+UInt256 uint512_hi( UInt512 val );
+
+// Shift given UInt256 value left by specified number of bits
+// (shift must be less than 256).
 UInt256 uint256_lshift( UInt256 val, unsigned shift );
 
+// Compute val >> shift (shift must be less than 256).
+UInt256 uint256_rshift( UInt256 val, unsigned shift );
+
+// Rotate val left by shift bits (any shift, taken modulo 256).
+UInt256 uint256_rotl( UInt256 val, unsigned shift );
+
+// Rotate val right by shift bits (any shift, taken modulo 256).
+UInt256 uint256_rotr( UInt256 val, unsigned shift );
+
+// Compute the bitwise AND of two UInt256 values.
+UInt256 uint256_and( UInt256 left, UInt256 right );
+
+// Compute the bitwise OR of two UInt256 values.
+UInt256 uint256_or( UInt256 left, UInt256 right );
+
+// Compute the bitwise XOR of two UInt256 values.
+UInt256 uint256_xor( UInt256 left, UInt256 right );
+
+// Compute the bitwise complement of a UInt256 value.
+UInt256 uint256_not( UInt256 val );
+
+// In-place, pointer-based variants of the arithmetic and bitwise
+// operations follow, for loops where passing 32-byte values around
+// costs more than the operation itself. Each writes its result to
+// dst, which may alias either operand. uint256_inline.h has
+// header-only versions of the cheap ones.
+
+// Compute *a + *b into dst (e.g. uint256_add_to( &acc, &acc, &x )
+// accumulates into acc).
+void uint256_add_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute *a - *b into dst.
+void uint256_sub_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute the two's complement negation of *a into dst.
+void uint256_negate_to( UInt256 *dst, const UInt256 *a );
+
+// Compute the low 256 bits of *a * *b into dst.
+void uint256_mul_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute the low 256 bits of *a squared into dst.
+void uint256_sqr_to( UInt256 *dst, const UInt256 *a );
+
+// Compute *a shifted left by shift bits into dst (shift must be
+// less than 256).
+void uint256_lshift_to( UInt256 *dst, const UInt256 *a, unsigned shift );
+
+// Compute *a shifted right by shift bits into dst (shift must be
+// less than 256).
+void uint256_rshift_to( UInt256 *dst, const UInt256 *a, unsigned shift );
+
+// Compute the bitwise AND of *a and *b into dst.
+void uint256_and_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute the bitwise OR of *a and *b into dst.
+void uint256_or_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute the bitwise XOR of *a and *b into dst.
+void uint256_xor_to( UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Compute the bitwise complement of *a into dst.
+void uint256_not_to( UInt256 *dst, const UInt256 *a );
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif // UINT256_H
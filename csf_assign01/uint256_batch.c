@@ -0,0 +1,287 @@
+#include "uint256_batch.h"
+#include "uint256_limb.h"
+#include "uint256_inline.h"
+
+// Values handled per AVX2 block: one 64-bit lane per value
+#define BATCH_LANES 4
+
+#ifdef UINT256_X86_INTRIN
+#define BATCH_AVX2 __attribute__((target("avx2")))
+
+// Transpose four values (one ymm of four limbs each) into four
+// limb vectors (one ymm holding limb k of every value), or back;
+// the 4x4 transpose is its own inverse. Kept in named registers
+// rather than an array so GCC doesn't spill the block to the stack.
+BATCH_AVX2 static inline void batch_transpose( __m256i *r0, __m256i *r1, __m256i *r2, __m256i *r3 ) {
+  __m256i t0 = _mm256_unpacklo_epi64(*r0, *r1);
+  __m256i t1 = _mm256_unpackhi_epi64(*r0, *r1);
+  __m256i t2 = _mm256_unpacklo_epi64(*r2, *r3);
+  __m256i t3 = _mm256_unpackhi_epi64(*r2, *r3);
+  *r0 = _mm256_permute2x128_si256(t0, t2, 0x20);
+  *r1 = _mm256_permute2x128_si256(t1, t3, 0x20);
+  *r2 = _mm256_permute2x128_si256(t0, t2, 0x31);
+  *r3 = _mm256_permute2x128_si256(t1, t3, 0x31);
+}
+
+#define BATCH_LOAD(r0, r1, r2, r3, src) do { \
+    r0 = _mm256_loadu_si256((const __m256i *) (src)[0].data); \
+    r1 = _mm256_loadu_si256((const __m256i *) (src)[1].data); \
+    r2 = _mm256_loadu_si256((const __m256i *) (src)[2].data); \
+    r3 = _mm256_loadu_si256((const __m256i *) (src)[3].data); \
+    batch_transpose(&r0, &r1, &r2, &r3); \
+  } while (0)
+
+#define BATCH_STORE(dst, r0, r1, r2, r3) do { \
+    batch_transpose(&r0, &r1, &r2, &r3); \
+    _mm256_storeu_si256((__m256i *) (dst)[0].data, r0); \
+    _mm256_storeu_si256((__m256i *) (dst)[1].data, r1); \
+    _mm256_storeu_si256((__m256i *) (dst)[2].data, r2); \
+    _mm256_storeu_si256((__m256i *) (dst)[3].data, r3); \
+  } while (0)
+
+// a <u b per 64-bit lane (AVX2 only has a signed compare, so both
+// sides are biased by 2^63 first)
+BATCH_AVX2 static inline __m256i batch_ltu( __m256i a, __m256i b ) {
+  const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+  return _mm256_cmpgt_epi64(_mm256_xor_si256(b, bias), _mm256_xor_si256(a, bias));
+}
+
+// One limb of four additions at once. Carries are all-ones lane
+// masks, so adding a carry in is a subtraction of the mask; a carry
+// out comes either from x + y wrapping, or from the carry in
+// wrapping an all-ones sum to zero.
+BATCH_AVX2 static inline __m256i batch_addc( __m256i x, __m256i y, __m256i *carry ) {
+  __m256i t = _mm256_add_epi64(x, y);
+  __m256i s = _mm256_sub_epi64(t, *carry);
+  __m256i wrap = _mm256_and_si256(*carry, _mm256_cmpeq_epi64(s, _mm256_setzero_si256()));
+  *carry = _mm256_or_si256(batch_ltu(t, x), wrap);
+  return s;
+}
+
+// Same with borrows: a borrow out comes from x < y, or from the
+// borrow in wrapping a zero difference.
+BATCH_AVX2 static inline __m256i batch_subb( __m256i x, __m256i y, __m256i *borrow ) {
+  __m256i t = _mm256_sub_epi64(x, y);
+  __m256i d = _mm256_add_epi64(t, *borrow);
+  __m256i wrap = _mm256_and_si256(*borrow, _mm256_cmpeq_epi64(t, _mm256_setzero_si256()));
+  *borrow = _mm256_or_si256(batch_ltu(x, y), wrap);
+  return d;
+}
+
+// Four values per call, transposed to limb-major form so each
+// instruction works on the same limb of all four.
+BATCH_AVX2 static void add_block_avx2( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  __m256i x0, x1, x2, x3, y0, y1, y2, y3;
+  __m256i carry = _mm256_setzero_si256();
+  BATCH_LOAD(x0, x1, x2, x3, a);
+  BATCH_LOAD(y0, y1, y2, y3, b);
+  x0 = batch_addc(x0, y0, &carry);
+  x1 = batch_addc(x1, y1, &carry);
+  x2 = batch_addc(x2, y2, &carry);
+  x3 = batch_addc(x3, y3, &carry);
+  BATCH_STORE(dst, x0, x1, x2, x3);
+}
+
+BATCH_AVX2 static void sub_block_avx2( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  __m256i x0, x1, x2, x3, y0, y1, y2, y3;
+  __m256i borrow = _mm256_setzero_si256();
+  BATCH_LOAD(x0, x1, x2, x3, a);
+  BATCH_LOAD(y0, y1, y2, y3, b);
+  x0 = batch_subb(x0, y0, &borrow);
+  x1 = batch_subb(x1, y1, &borrow);
+  x2 = batch_subb(x2, y2, &borrow);
+  x3 = batch_subb(x3, y3, &borrow);
+  BATCH_STORE(dst, x0, x1, x2, x3);
+}
+#endif
+
+// Return 1 if the batch kernels use the AVX2 path on this machine,
+// 0 if they fall back to the scalar limb code.
+int uint256_batch_simd( void ) {
+#ifdef UINT256_X86_INTRIN
+  return __builtin_cpu_supports("avx2");
+#else
+  return 0;
+#endif
+}
+
+void uint256_add_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  size_t i = 0;
+#ifdef UINT256_X86_INTRIN
+  if (uint256_batch_simd()) {
+    for (; i + BATCH_LANES <= n; i += BATCH_LANES) {
+      add_block_avx2(dst + i, a + i, b + i);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    uint256_add_inline(dst + i, a + i, b + i);
+  }
+}
+
+void uint256_sub_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  size_t i = 0;
+#ifdef UINT256_X86_INTRIN
+  if (uint256_batch_simd()) {
+    for (; i + BATCH_LANES <= n; i += BATCH_LANES) {
+      sub_block_avx2(dst + i, a + i, b + i);
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    uint256_sub_inline(dst + i, a + i, b + i);
+  }
+}
+
+// AVX2 has no 64x64-bit multiply (only 32x32 -> 64 in
+// _mm256_mul_epu32), so four lanes of 32-bit schoolbook products
+// lose to one lane of the 64-bit Comba kernel; the products stay
+// on the scalar limb code.
+void uint256_mul_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (size_t i = 0; i < n; i++) {
+    uint64_t x[4], y[4], p[4];
+    limbs_load(x, a + i);
+    limbs_load(y, b + i);
+    limbs_mul_lo_dispatch(p, x, y);
+    limbs_store(dst + i, p);
+  }
+}
+
+// Words each partial sum can take between normalizations. A word
+// is below 2^32, so after ACC_ROOM of them a partial sum is at most
+// (2^32 - 1)^2 and adding the carry in from below can't overflow it.
+#define ACC_ROOM (UINT32_MAX - 1)
+
+// Fold each partial sum's high half into the next one up, leaving
+// every partial sum below 2^32 and the carry out of the top word in
+// wraps.
+static void acc_normalize( UInt256Accumulator *acc ) {
+  uint64_t carry = 0;
+  for (int i = 0; i < 8; i++) {
+    uint64_t t = acc->sum[i] + carry;
+    acc->sum[i] = t & UINT32_MAX;
+    carry = t >> 32;
+  }
+  acc->wraps += carry;
+  acc->room = ACC_ROOM;
+}
+
+// Take n words of room, normalizing first if there isn't enough
+static inline void acc_reserve( UInt256Accumulator *acc, uint32_t n ) {
+  if (acc->room < n) {
+    acc_normalize(acc);
+  }
+  acc->room -= n;
+}
+
+static inline void acc_add_words( uint64_t sum[8], const uint32_t w[8] ) {
+  for (int i = 0; i < 8; i++) {
+    sum[i] += w[i];
+  }
+}
+
+#ifdef UINT256_X86_INTRIN
+// Add n values (n within the headroom) with the partial sums held
+// in two ymm registers: each value is one load, two zero-extends of
+// four words to 64 bits, and two adds.
+BATCH_AVX2 static void acc_add_array_avx2( uint64_t sum[8], const UInt256 *vals, size_t n ) {
+  __m256i lo = _mm256_loadu_si256((const __m256i *) sum);
+  __m256i hi = _mm256_loadu_si256((const __m256i *) (sum + 4));
+  for (size_t i = 0; i < n; i++) {
+    __m256i v = _mm256_loadu_si256((const __m256i *) vals[i].data);
+    lo = _mm256_add_epi64(lo, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+    hi = _mm256_add_epi64(hi, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  _mm256_storeu_si256((__m256i *) sum, lo);
+  _mm256_storeu_si256((__m256i *) (sum + 4), hi);
+}
+#endif
+
+void uint256_acc_init( UInt256Accumulator *acc ) {
+  memset(acc, 0, sizeof(*acc));
+  acc->room = ACC_ROOM;
+}
+
+void uint256_acc_add( UInt256Accumulator *acc, const UInt256 *val ) {
+  acc_reserve(acc, 1);
+  acc_add_words(acc->sum, val->data);
+}
+
+void uint256_acc_add_array( UInt256Accumulator *acc, const UInt256 *vals, size_t n ) {
+  while (n > 0) {
+    //add as many values as the headroom allows with no checks in
+    //the loop, so it runs at load/add throughput
+    if (acc->room == 0) {
+      acc_normalize(acc);
+    }
+    size_t chunk = n < acc->room ? n : acc->room;
+#ifdef UINT256_X86_INTRIN
+    if (uint256_batch_simd()) {
+      acc_add_array_avx2(acc->sum, vals, chunk);
+    } else
+#endif
+    {
+      uint64_t sum[8];
+      memcpy(sum, acc->sum, sizeof(sum));
+      for (size_t i = 0; i < chunk; i++) {
+        acc_add_words(sum, vals[i].data);
+      }
+      memcpy(acc->sum, sum, sizeof(sum));
+    }
+    acc->room -= (uint32_t) chunk;
+    vals += chunk;
+    n -= chunk;
+  }
+}
+
+// The product's own carries stay inside limbs_mul_lo; only its
+// words go into the partial sums, so consecutive products don't
+// wait on each other. (Going through a UInt256 and the word adds
+// measured faster than splitting the limbs in registers, which runs
+// out of registers with the product live.)
+static inline void acc_mul_add_words( uint64_t sum[8], const UInt256 *a, const UInt256 *b ) {
+  uint64_t x[4], y[4], p[4];
+  UInt256 prod;
+  limbs_load(x, a);
+  limbs_load(y, b);
+  limbs_mul_lo_dispatch(p, x, y);
+  limbs_store(&prod, p);
+  acc_add_words(sum, prod.data);
+}
+
+void uint256_acc_mul_add( UInt256Accumulator *acc, const UInt256 *a, const UInt256 *b ) {
+  acc_reserve(acc, 1);
+  acc_mul_add_words(acc->sum, a, b);
+}
+
+void uint256_acc_dot( UInt256Accumulator *acc, const UInt256 *a, const UInt256 *b, size_t n ) {
+  while (n > 0) {
+    if (acc->room == 0) {
+      acc_normalize(acc);
+    }
+    size_t chunk = n < acc->room ? n : acc->room;
+    //partial sums in a local array so they stay in registers
+    uint64_t sum[8];
+    memcpy(sum, acc->sum, sizeof(sum));
+    for (size_t i = 0; i < chunk; i++) {
+      acc_mul_add_words(sum, a + i, b + i);
+    }
+    memcpy(acc->sum, sum, sizeof(sum));
+    acc->room -= (uint32_t) chunk;
+    a += chunk;
+    b += chunk;
+    n -= chunk;
+  }
+}
+
+UInt256 uint256_acc_value( UInt256Accumulator *acc, uint64_t *wraps ) {
+  UInt256 result;
+  acc_normalize(acc);
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = (uint32_t) acc->sum[i];
+  }
+  if (wraps) {
+    *wraps = acc->wraps;
+  }
+  return result;
+}
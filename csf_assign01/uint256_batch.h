@@ -0,0 +1,64 @@
+#ifndef UINT256_BATCH_H
+#define UINT256_BATCH_H
+
+#include <stddef.h>
+#include "uint256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Element-wise operations over arrays of n UInt256 values:
+// dst[i] = a[i] op b[i] for 0 <= i < n, with the same wraparound
+// results as the scalar uint256_add/uint256_sub/uint256_mul, which
+// remain the reference. dst may be the same array as a or b, but
+// must not otherwise overlap them.
+void uint256_add_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b );
+void uint256_sub_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b );
+void uint256_mul_batch( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+// Running sum of UInt256 values with the carries left unresolved:
+// sum[i] collects word i of every value added, so an addition is
+// eight independent adds rather than one carry chain through all
+// eight words. The carries are resolved only when the sum is read or
+// a partial sum is about to run out of headroom. Initialize with
+// uint256_acc_init before use.
+typedef struct {
+  uint64_t sum[8];  // partial sums, one per 32-bit word
+  uint64_t wraps;   // carries out of bit 255 resolved so far
+  uint32_t room;    // 32-bit words each partial sum can still take
+} UInt256Accumulator;
+
+// Reset the accumulator to zero.
+void uint256_acc_init( UInt256Accumulator *acc );
+
+// acc += val.
+void uint256_acc_add( UInt256Accumulator *acc, const UInt256 *val );
+
+// acc += vals[0] + ... + vals[n-1].
+void uint256_acc_add_array( UInt256Accumulator *acc, const UInt256 *vals, size_t n );
+
+// acc += a * b, with the product truncated to 256 bits as in
+// uint256_mul.
+void uint256_acc_mul_add( UInt256Accumulator *acc, const UInt256 *a, const UInt256 *b );
+
+// acc += a[0]*b[0] + ... + a[n-1]*b[n-1] (the dot product of two
+// arrays), each product truncated as in uint256_acc_mul_add.
+void uint256_acc_dot( UInt256Accumulator *acc, const UInt256 *a, const UInt256 *b, size_t n );
+
+// Return the sum modulo 2^256, i.e. the same value a chain of
+// uint256_add calls would give. If wraps is not NULL, the number of
+// times the sum passed 2^256 (the bits above bit 255, modulo 2^64)
+// is stored through it. Resolves the pending carries in acc, which
+// can keep accumulating afterwards.
+UInt256 uint256_acc_value( UInt256Accumulator *acc, uint64_t *wraps );
+
+// Return 1 if the batch kernels use the AVX2 path on this machine,
+// 0 if they fall back to the scalar limb code.
+int uint256_batch_simd( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UINT256_BATCH_H
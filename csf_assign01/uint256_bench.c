@@ -0,0 +1,828 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "uint256.h"
+#include "uint256_mod.h"
+#include "uint256_inline.h"
+#include "uint256_batch.h"
+#include "uint256_io.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+// Number of distinct operands cycled through by each benchmark
+#define NVALS 1024
+
+typedef UInt256 (*BinOp)( UInt256 left, UInt256 right );
+typedef UInt256 (*UnOp)( UInt256 val );
+
+static UInt256 lhs[NVALS], rhs[NVALS];
+static volatile uint32_t sink;
+
+// xorshift64*, fixed seed so runs are comparable
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+static uint64_t rng_next( void ) {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static UInt256 random_val( void ) {
+  UInt256 val;
+  for (int i = 0; i < 8; i += 2) {
+    uint64_t r = rng_next();
+    val.data[i] = (uint32_t) r;
+    val.data[i + 1] = (uint32_t) (r >> 32);
+  }
+  return val;
+}
+
+static uint64_t cycles_now( void ) {
+#ifdef BENCH_HAVE_TSC
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static double ns_now( void ) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Output as CSV (-c) rather than aligned text, and the operand set
+// the results being reported were measured on
+static int csv_output;
+static const char *operand_set = "default";
+
+static void report( const char *name, unsigned long ops, double ns, uint64_t cycles ) {
+  if (csv_output) {
+    printf("%s,%s,%lu,%.3f,%.3f\n", name, operand_set, ops, ns / ops, (double) cycles / ops);
+  } else {
+    printf("%-24s %-8s %10.2f ns/op %10.2f cycles/op\n", name, operand_set, ns / ops, (double) cycles / ops);
+  }
+}
+
+static void bench_binop( const char *name, BinOp fn, unsigned reps ) {
+  uint32_t acc = 0;
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc ^= fn(lhs[i], rhs[i]).data[r & 7];
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = acc;
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+static void bench_unop( const char *name, UnOp fn, unsigned reps ) {
+  uint32_t acc = 0;
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc ^= fn(lhs[i]).data[r & 7];
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = acc;
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+// Running sums over the operand array, by value, through the
+// pointer API, and through the header-only inline version
+static void bench_accumulate( unsigned reps ) {
+  UInt256 acc = uint256_create_from_u32(0);
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc = uint256_add(acc, lhs[i]);
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = acc.data[0];
+  report("accumulate/value", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+
+  t0 = ns_now();
+  c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      uint256_add_to(&acc, &acc, &lhs[i]);
+    }
+  }
+  c1 = cycles_now();
+  t1 = ns_now();
+  sink = acc.data[0];
+  report("accumulate/add_to", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+
+  t0 = ns_now();
+  c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      uint256_add_inline(&acc, &acc, &lhs[i]);
+    }
+  }
+  c1 = cycles_now();
+  t1 = ns_now();
+  sink = acc.data[0];
+  report("accumulate/inline", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+
+  UInt256Accumulator lazy;
+  uint256_acc_init(&lazy);
+  t0 = ns_now();
+  c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      uint256_acc_add(&lazy, &lhs[i]);
+    }
+  }
+  c1 = cycles_now();
+  t1 = ns_now();
+  sink = uint256_acc_value(&lazy, NULL).data[0];
+  report("accumulate/acc", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+
+  t0 = ns_now();
+  c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    uint256_acc_add_array(&lazy, lhs, NVALS);
+  }
+  c1 = cycles_now();
+  t1 = ns_now();
+  sink = uint256_acc_value(&lazy, NULL).data[0];
+  report("accumulate/acc_array", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+// Dot product of the operand arrays: multiply and add by value,
+// against the lazy-carry accumulator
+static void bench_dot( unsigned reps ) {
+  UInt256 acc = uint256_create_from_u32(0);
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc = uint256_add(acc, uint256_mul(lhs[i], rhs[i]));
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = acc.data[0];
+  report("dot/mul_add", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+
+  UInt256Accumulator lazy;
+  uint256_acc_init(&lazy);
+  t0 = ns_now();
+  c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    uint256_acc_dot(&lazy, lhs, rhs, NVALS);
+  }
+  c1 = cycles_now();
+  t1 = ns_now();
+  sink = uint256_acc_value(&lazy, NULL).data[0];
+  report("dot/acc", (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+typedef void (*BatchOp)( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b );
+
+static UInt256 batch_out[NVALS];
+
+static void bench_batch( const char *name, BatchOp fn, unsigned reps ) {
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    fn(NVALS, batch_out, lhs, rhs);
+    sink ^= batch_out[r % NVALS].data[0];
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+// Element-at-a-time loops over the scalar API, the baseline for
+// the batch kernels
+static void add_loop( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (size_t i = 0; i < n; i++) {
+    uint256_add_to(dst + i, a + i, b + i);
+  }
+}
+
+static void sub_loop( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (size_t i = 0; i < n; i++) {
+    uint256_sub_to(dst + i, a + i, b + i);
+  }
+}
+
+static void mul_loop( size_t n, UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (size_t i = 0; i < n; i++) {
+    uint256_mul_to(dst + i, a + i, b + i);
+  }
+}
+
+// The original 32-bit limb add/sub/negate, kept here as the
+// baseline the library implementation is compared against.
+static UInt256 legacy_add( UInt256 left, UInt256 right ) {
+  uint32_t carry = 0;
+  UInt256 sum;
+  for (int i = 0; i < 8; i++) {
+    uint32_t leftval = left.data[i];
+    sum.data[i] = left.data[i] + right.data[i] + carry;
+    if (sum.data[i] < leftval || (sum.data[i] == leftval && carry == 1)) {
+      carry = 1;
+    } else {
+      carry = 0;
+    }
+  }
+  return sum;
+}
+
+static UInt256 legacy_negate( UInt256 val ) {
+  UInt256 result;
+  for (int i = 0; i < 8; i++) {
+    result.data[i] = ~val.data[i];
+  }
+  return legacy_add(result, uint256_create_from_u32(1));
+}
+
+static UInt256 legacy_sub( UInt256 left, UInt256 right ) {
+  return legacy_add(left, legacy_negate(right));
+}
+
+// The original shift-and-add multiply (one lshift + add per set bit)
+static UInt256 legacy_lshift( UInt256 val, unsigned shift ) {
+  unsigned indexshift = shift / 32;
+  unsigned bitshift = shift % 32;
+  UInt256 temp = uint256_create_from_u32(0);
+  UInt256 result = uint256_create_from_u32(0);
+  for (int i = 7; i >= 0; i--) {
+    uint32_t right = val.data[i] << bitshift;
+    uint32_t left = bitshift > 0 ? val.data[i] >> (32 - bitshift) : 0;
+    if (i + indexshift < 8) {
+      temp.data[i + indexshift] = right;
+    }
+    if (i + indexshift + 1 < 8) {
+      temp.data[i + indexshift + 1] = left;
+    }
+    result = legacy_add(result, temp);
+    temp = uint256_create_from_u32(0);
+  }
+  return result;
+}
+
+static UInt256 legacy_mul( UInt256 left, UInt256 right ) {
+  UInt256 product = uint256_create_from_u32(0);
+  for (int index = 0; index < 8; index++) {
+    for (int bitindex = 0; bitindex < 32; bitindex++) {
+      if (right.data[index] & (1u << bitindex)) {
+        product = legacy_add(product, legacy_lshift(left, index*32 + bitindex));
+      }
+    }
+  }
+  return product;
+}
+
+typedef size_t (*FormatFn)( UInt256 val, char *buf, size_t len );
+
+static void bench_format( const char *name, FormatFn fn, unsigned reps ) {
+  char buf[UINT256_DEC_BUFSIZE];
+  size_t acc = 0;
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc += fn(lhs[i], buf, sizeof(buf));
+      acc += (unsigned char) buf[0];
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = (uint32_t) acc;
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+// The original sprintf/strcat hex formatter, minus the allocation
+static size_t legacy_format_hex( UInt256 val, char *buf, size_t len ) {
+  char temp[9];
+  int index = 7;
+  (void) len;
+  buf[0] = '\0';
+  while (index > 0 && val.data[index] == 0) {
+    index--;
+  }
+  sprintf(temp, "%x", val.data[index]);
+  strcat(buf, temp);
+  for (int i = index - 1; i >= 0; i--) {
+    sprintf(temp, "%08x", val.data[i]);
+    strcat(buf, temp);
+  }
+  return strlen(buf);
+}
+
+// Digit-at-a-time decimal conversions, the baseline for the
+// chunked library versions
+static size_t naive_format_dec( UInt256 val, char *buf, size_t len ) {
+  char temp[UINT256_DEC_BUFSIZE];
+  size_t n = 0;
+  (void) len;
+  do {
+    uint64_t digit;
+    val = uint256_divmod_u64(val, 10, &digit);
+    temp[n++] = (char) ('0' + digit);
+  } while (uint256_cmp(val, uint256_create_from_u32(0)) != 0);
+  for (size_t i = 0; i < n; i++) {
+    buf[i] = temp[n - 1 - i];
+  }
+  buf[n] = '\0';
+  return n;
+}
+
+static UInt256 naive_create_from_dec( const char *dec ) {
+  UInt256 result = uint256_create_from_u32(0);
+  UInt256 ten = uint256_create_from_u32(10);
+  for (; *dec >= '0' && *dec <= '9'; dec++) {
+    result = uint256_add(uint256_mul(result, ten), uint256_create_from_u32(*dec - '0'));
+  }
+  return result;
+}
+
+typedef UInt256 (*ParseFn)( const char *str );
+
+static char dec_strs[NVALS][UINT256_DEC_BUFSIZE];
+
+static void bench_parse( const char *name, ParseFn fn, char strs[][UINT256_DEC_BUFSIZE], unsigned reps ) {
+  uint32_t acc = 0;
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    for (int i = 0; i < NVALS; i++) {
+      acc ^= fn(strs[i]).data[r & 7];
+    }
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  sink = acc;
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+typedef void (*EncodeFn)( uint8_t *out, const UInt256 *vals, size_t n );
+typedef void (*DecodeFn)( UInt256 *vals, const uint8_t *in, size_t n );
+
+static uint8_t byte_buf[NVALS * UINT256_BYTES];
+
+// Binary conversion of the whole operand array per call, reported
+// per value for comparison with the text formats
+static void bench_encode( const char *name, EncodeFn fn, unsigned reps ) {
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    fn(byte_buf, lhs, NVALS);
+    sink ^= byte_buf[r % sizeof(byte_buf)];
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+static void bench_decode( const char *name, DecodeFn fn, unsigned reps ) {
+  double t0 = ns_now();
+  uint64_t c0 = cycles_now();
+  for (unsigned r = 0; r < reps; r++) {
+    fn(batch_out, byte_buf, NVALS);
+    sink ^= batch_out[r % NVALS].data[0];
+  }
+  uint64_t c1 = cycles_now();
+  double t1 = ns_now();
+  report(name, (unsigned long) reps * NVALS, t1 - t0, c1 - c0);
+}
+
+// The original strtoul-per-8-digits hex parser
+static UInt256 legacy_create_from_hex( const char *hex ) {
+  UInt256 result = uint256_create_from_u32(0);
+  size_t length = strlen(hex);
+  if (length > 64) {
+    hex += length - 64;
+    length = 64;
+  }
+  const char *position = hex + length - 1;
+  int i = 0;
+  while (length > 0) {
+    char eightBits[9] = {0};
+    int size = length < 8 ? (int) length : 8;
+    for (int k = size - 1; k >= 0; k--) {
+      eightBits[k] = *position;
+      position--;
+    }
+    result.data[i] = strtoul(eightBits, NULL, 16);
+    i++;
+    length -= size;
+  }
+  return result;
+}
+
+static UInt256 parse_hex( const char *hex ) {
+  UInt256 result = uint256_create_from_u32(0);
+  uint256_parse_hex(hex, strlen(hex), &result);
+  return result;
+}
+
+static char hex_strs[NVALS][UINT256_DEC_BUFSIZE];
+
+static UInt256 create_words( UInt256 val ) {
+  return uint256_create(val.data);
+}
+
+// Shifts by a data-dependent amount taken from the right operand
+static UInt256 lshift_legacy_var( UInt256 left, UInt256 right ) {
+  return legacy_lshift(left, right.data[0] % 256);
+}
+
+static UInt256 lshift_var( UInt256 left, UInt256 right ) {
+  return uint256_lshift(left, right.data[0] % 256);
+}
+
+static UInt256 rshift_var( UInt256 left, UInt256 right ) {
+  return uint256_rshift(left, right.data[0] % 256);
+}
+
+static UInt256 rotl_var( UInt256 left, UInt256 right ) {
+  return uint256_rotl(left, right.data[0]);
+}
+
+static UInt256 mul_wide_hi( UInt256 left, UInt256 right ) {
+  return uint512_hi(uint256_mul_wide(left, right));
+}
+
+//the word operands, and the full-width operands they used to need
+static uint64_t word_of( UInt256 val ) {
+  return (uint64_t) val.data[0] | ((uint64_t) val.data[1] << 32);
+}
+
+static UInt256 add_word_full( UInt256 left, UInt256 right ) {
+  uint64_t w = word_of(right);
+  UInt256 wide = uint256_create_from_u32((uint32_t) w);
+  wide.data[1] = (uint32_t) (w >> 32);
+  return uint256_add(left, wide);
+}
+
+static UInt256 add_u64( UInt256 left, UInt256 right ) {
+  return uint256_add_u64(left, word_of(right));
+}
+
+static UInt256 mul_word_full( UInt256 left, UInt256 right ) {
+  uint64_t w = word_of(right);
+  UInt256 wide = uint256_create_from_u32((uint32_t) w);
+  wide.data[1] = (uint32_t) (w >> 32);
+  return uint256_mul(left, wide);
+}
+
+static UInt256 mul_u64( UInt256 left, UInt256 right ) {
+  return uint256_mul_u64(left, word_of(right));
+}
+
+//the flag is folded into the result so it can't be optimized away
+static UInt256 add_carry( UInt256 left, UInt256 right ) {
+  UInt256 sum;
+  int carry = uint256_add_carry(left, right, &sum);
+  sum.data[0] ^= carry;
+  return sum;
+}
+
+//what checking a product cost before uint256_mul_checked
+static UInt256 mul_then_check( UInt256 left, UInt256 right ) {
+  UInt256 product = uint256_mul(left, right);
+  product.data[0] ^= uint256_mul_overflows(left, right);
+  return product;
+}
+
+static UInt256 mul_checked( UInt256 left, UInt256 right ) {
+  UInt256 product;
+  int overflow = uint256_mul_checked(left, right, &product);
+  product.data[0] ^= overflow;
+  return product;
+}
+
+static UInt256 div_by_half( UInt256 left, UInt256 right ) {
+  //keep the divisor to ~128 bits so the quotient has several limbs
+  right.data[4] = right.data[5] = right.data[6] = right.data[7] = 0;
+  right.data[3] |= 1;
+  return uint256_div(left, right);
+}
+
+static UInt256 div_by_u64( UInt256 val ) {
+  return uint256_divmod_u64(val, 10000000000000000000ULL, NULL);
+}
+
+// Modulus shared by the modular-arithmetic benchmarks (2^255 - 19)
+static UInt256MontCtx mont;
+
+static UInt256 mulmod_divmod( UInt256 left, UInt256 right ) {
+  return uint512_mod(uint256_mul_wide(left, right), mont.mod);
+}
+
+static UInt256BarrettCtx barrett;
+
+static UInt256 barrett_mul( UInt256 left, UInt256 right ) {
+  return uint256_barrett_mul(&barrett, left, right);
+}
+
+static UInt256 mont_mul( UInt256 left, UInt256 right ) {
+  return uint256_mont_mul(&mont, left, right);
+}
+
+static UInt256 mont_sqr( UInt256 val ) {
+  return uint256_mont_sqr(&mont, val);
+}
+
+static UInt256 modexp( UInt256 left, UInt256 right ) {
+  return uint256_mont_exp(&mont, left, right);
+}
+
+static UInt256 modexp_ct( UInt256 left, UInt256 right ) {
+  return uint256_mont_exp_ct(&mont, left, right);
+}
+
+// Bit scans one bit at a time through uint256_is_bit_set, the way
+// callers had to before the scan functions, against the limb versions
+static UInt256 bit_length_loop( UInt256 val ) {
+  unsigned n = 256;
+  while (n > 0 && !uint256_is_bit_set(val, n - 1)) {
+    n--;
+  }
+  return uint256_create_from_u32(n);
+}
+
+static UInt256 bit_length( UInt256 val ) {
+  return uint256_create_from_u32(uint256_bit_length(val));
+}
+
+static UInt256 popcount_loop( UInt256 val ) {
+  unsigned n = 0;
+  for (unsigned i = 0; i < 256; i++) {
+    n += uint256_is_bit_set(val, i);
+  }
+  return uint256_create_from_u32(n);
+}
+
+static UInt256 popcount( UInt256 val ) {
+  return uint256_create_from_u32(uint256_popcount(val));
+}
+
+// Sum of the indices of the set bits of a sparse value (val masked
+// down to about one bit in 64)
+static UInt256 bit_walk_loop( UInt256 val ) {
+  UInt256 sparse = uint256_and(val, uint256_and(uint256_rotl(val, 17), uint256_rotl(val, 101)));
+  sparse = uint256_and(sparse, uint256_and(uint256_rotl(val, 45), uint256_rotl(val, 200)));
+  sparse = uint256_and(sparse, uint256_rotl(val, 77));
+  unsigned sum = 0;
+  for (unsigned i = 0; i < 256; i++) {
+    if (uint256_is_bit_set(sparse, i)) {
+      sum += i;
+    }
+  }
+  return uint256_create_from_u32(sum);
+}
+
+static UInt256 bit_walk( UInt256 val ) {
+  UInt256 sparse = uint256_and(val, uint256_and(uint256_rotl(val, 17), uint256_rotl(val, 101)));
+  sparse = uint256_and(sparse, uint256_and(uint256_rotl(val, 45), uint256_rotl(val, 200)));
+  sparse = uint256_and(sparse, uint256_rotl(val, 77));
+  unsigned sum = 0;
+  for (unsigned i = uint256_next_set_bit(sparse, 0); i < 256; i = uint256_next_set_bit(sparse, i + 1)) {
+    sum += i;
+  }
+  return uint256_create_from_u32(sum);
+}
+
+// Euclid's algorithm on the division routines, the baseline for
+// the binary GCD
+static UInt256 gcd_euclid( UInt256 left, UInt256 right ) {
+  UInt256 zero = uint256_create_from_u32(0);
+  while (uint256_cmp(right, zero) != 0) {
+    UInt256 r = uint256_mod(left, right);
+    left = right;
+    right = r;
+  }
+  return left;
+}
+
+// Inverses modulo the Montgomery context's odd prime, and modulo
+// the even value just below it
+static UInt256 modinv_odd( UInt256 val ) {
+  UInt256 inv = val;
+  uint256_modinv(val, mont.mod, &inv);
+  return inv;
+}
+
+static UInt256 modinv_even( UInt256 val ) {
+  UInt256 inv = val;
+  uint256_modinv(val, uint256_sub(mont.mod, uint256_create_from_u32(1)), &inv);
+  return inv;
+}
+
+// Bit-at-a-time square-and-multiply, for comparison
+static UInt256 modexp_binary( UInt256 left, UInt256 right ) {
+  UInt256 result = mont.one, base = uint256_to_mont(&mont, left);
+  for (int bit = 255; bit >= 0; bit--) {
+    result = uint256_mont_sqr(&mont, result);
+    if (uint256_is_bit_set(right, bit)) {
+      result = uint256_mont_mul(&mont, result, base);
+    }
+  }
+  return uint256_from_mont(&mont, result);
+}
+
+// Operand distributions for the per-operation suite. Several of the
+// operations (the legacy multiply most of all) cost more the more
+// limbs or set bits their operands have.
+
+// Up to 64 significant bits
+static UInt256 small_val( void ) {
+  UInt256 val = uint256_create_from_u32(0);
+  uint64_t r = rng_next() >> (rng_next() % 64);
+  val.data[0] = (uint32_t) r;
+  val.data[1] = (uint32_t) (r >> 32);
+  return val;
+}
+
+// All 256 bits significant
+static UInt256 full_val( void ) {
+  UInt256 val = random_val();
+  val.data[7] |= 0x80000000U;
+  return val;
+}
+
+// Each value gets its own bit density, from all clear to all set
+static UInt256 density_val( void ) {
+  UInt256 val = uint256_create_from_u32(0);
+  uint64_t threshold = rng_next();
+  for (int i = 0; i < 256; i++) {
+    if (rng_next() < threshold) {
+      val.data[i / 32] |= 1U << (i % 32);
+    }
+  }
+  return val;
+}
+
+// The basic operations on one operand distribution. Overwrites the
+// operand arrays.
+static void bench_operands( const char *set, UInt256 (*gen)( void ), unsigned reps ) {
+  operand_set = set;
+  for (int i = 0; i < NVALS; i++) {
+    lhs[i] = gen();
+    rhs[i] = gen();
+    uint256_format_hex_into(lhs[i], hex_strs[i], UINT256_DEC_BUFSIZE);
+  }
+  bench_unop("create", create_words, reps);
+  bench_format("format_hex", uint256_format_hex_into, reps);
+  bench_parse("parse_hex", parse_hex, hex_strs, reps);
+  bench_binop("add", uint256_add, reps);
+  bench_binop("sub", uint256_sub, reps);
+  bench_unop("negate", uint256_negate, reps);
+  bench_binop("lshift", lshift_var, reps);
+  bench_binop("mul", uint256_mul, reps);
+  bench_binop("mul/legacy", legacy_mul, reps / 100 + 1);
+}
+
+static void usage( const char *prog ) {
+  fprintf(stderr, "usage: %s [-c] [-b] [reps]\n"
+          "  -c  print CSV: name,operands,ops,ns_per_op,cycles_per_op\n"
+          "  -b  only the basic operations on each operand distribution\n", prog);
+  exit(2);
+}
+
+int main( int argc, char **argv ) {
+  unsigned reps = 2000;
+  int basic_only = 0, opt;
+  while ((opt = getopt(argc, argv, "cb")) != -1) {
+    if (opt == 'c') {
+      csv_output = 1;
+    } else if (opt == 'b') {
+      basic_only = 1;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (optind < argc) {
+    reps = (unsigned) strtoul(argv[optind], NULL, 10);
+  }
+  if (csv_output) {
+    printf("name,operands,ops,ns_per_op,cycles_per_op\n");
+  }
+  if (basic_only) {
+    bench_operands("small", small_val, reps);
+    bench_operands("full", full_val, reps);
+    bench_operands("density", density_val, reps);
+    return 0;
+  }
+
+  for (int i = 0; i < NVALS; i++) {
+    lhs[i] = random_val();
+    rhs[i] = random_val();
+  }
+  for (int i = 0; i < NVALS; i++) {
+    uint256_format_dec_into(lhs[i], dec_strs[i], UINT256_DEC_BUFSIZE);
+    uint256_format_hex_into(lhs[i], hex_strs[i], UINT256_DEC_BUFSIZE);
+  }
+  uint256_mont_ctx_init(&mont, uint256_create_from_hex("7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed"));
+  uint256_barrett_ctx_init(&barrett, mont.mod);
+  for (int i = 0; i < NVALS; i++) {
+    //keep modular operands reduced so every path takes its fast case
+    lhs[i].data[7] &= 0x3fffffffU;
+    rhs[i].data[7] &= 0x3fffffffU;
+  }
+
+  bench_format("format_hex/legacy", legacy_format_hex, reps / 10 + 1);
+  bench_format("format_hex", uint256_format_hex_into, reps);
+  bench_parse("parse_hex/legacy", legacy_create_from_hex, hex_strs, reps / 10 + 1);
+  bench_parse("create_from_hex", uint256_create_from_hex, hex_strs, reps);
+  bench_parse("parse_hex", parse_hex, hex_strs, reps);
+  bench_format("format_dec/naive", naive_format_dec, reps / 10 + 1);
+  bench_format("format_dec", uint256_format_dec_into, reps);
+  bench_parse("parse_dec/naive", naive_create_from_dec, dec_strs, reps / 10 + 1);
+  bench_parse("parse_dec", uint256_create_from_dec, dec_strs, reps);
+  bench_encode("encode_be", uint256_encode_be, reps);
+  bench_decode("decode_be", uint256_decode_be, reps);
+  bench_encode("encode_le", uint256_encode_le, reps);
+  bench_decode("decode_le", uint256_decode_le, reps);
+  bench_binop("add/legacy", legacy_add, reps);
+  bench_binop("add", uint256_add, reps);
+  bench_accumulate(reps);
+  bench_batch("add/loop", add_loop, reps);
+  bench_batch("add_batch", uint256_add_batch, reps);
+  bench_binop("sub/legacy", legacy_sub, reps);
+  bench_binop("sub", uint256_sub, reps);
+  bench_batch("sub/loop", sub_loop, reps);
+  bench_batch("sub_batch", uint256_sub_batch, reps);
+  bench_unop("negate/legacy", legacy_negate, reps);
+  bench_unop("negate", uint256_negate, reps);
+  bench_binop("lshift/legacy", lshift_legacy_var, reps);
+  bench_binop("lshift", lshift_var, reps);
+  bench_binop("rshift", rshift_var, reps);
+  bench_binop("rotl", rotl_var, reps);
+  bench_binop("xor", uint256_xor, reps);
+  bench_unop("bit_length/loop", bit_length_loop, reps / 10 + 1);
+  bench_unop("bit_length", bit_length, reps);
+  bench_unop("popcount/loop", popcount_loop, reps / 10 + 1);
+  bench_unop("popcount", popcount, reps);
+  bench_unop("bit_walk/loop", bit_walk_loop, reps / 10 + 1);
+  bench_unop("bit_walk", bit_walk, reps);
+  bench_binop("mul/legacy", legacy_mul, reps / 100 + 1);
+  bench_binop("mul", uint256_mul, reps);
+  bench_batch("mul/loop", mul_loop, reps);
+  bench_batch("mul_batch", uint256_mul_batch, reps);
+  bench_dot(reps);
+  bench_unop("sqr", uint256_sqr, reps);
+  bench_binop("mul_wide/hi", mul_wide_hi, reps);
+  bench_binop("add/word", add_word_full, reps);
+  bench_binop("add_u64", add_u64, reps);
+  bench_binop("mul/word", mul_word_full, reps);
+  bench_binop("mul_u64", mul_u64, reps);
+  bench_binop("add_carry", add_carry, reps);
+  bench_binop("add_sat", uint256_add_sat, reps);
+  bench_binop("mul+overflows", mul_then_check, reps);
+  bench_binop("mul_checked", mul_checked, reps);
+  bench_binop("mul_sat", uint256_mul_sat, reps);
+  bench_binop("div/256by128", div_by_half, reps);
+  bench_unop("divmod_u64", div_by_u64, reps);
+  bench_binop("mulmod/divmod", mulmod_divmod, reps);
+  bench_binop("gcd/euclid", gcd_euclid, reps / 100 + 1);
+  bench_binop("gcd", uint256_gcd, reps / 100 + 1);
+  bench_unop("modinv/odd", modinv_odd, reps / 100 + 1);
+  bench_unop("modinv/even", modinv_even, reps / 100 + 1);
+  bench_unop("isqrt", uint256_isqrt, reps / 10 + 1);
+  bench_binop("barrett_mul", barrett_mul, reps);
+  bench_binop("mont_mul", mont_mul, reps);
+  bench_unop("mont_sqr", mont_sqr, reps);
+  bench_binop("modexp/binary", modexp_binary, reps / 200 + 1);
+  bench_binop("modexp", modexp, reps / 200 + 1);
+  bench_binop("modexp_ct", modexp_ct, reps / 200 + 1);
+
+  //the multiplies above ran on the MULX/ADX kernels if the CPU has
+  //them; time the portable limb code for comparison
+  if (uint256_use_adx(1)) {
+    uint256_use_adx(0);
+    bench_binop("mul/portable", uint256_mul, reps);
+    bench_batch("mul_batch/portable", uint256_mul_batch, reps);
+    bench_binop("mul_wide/hi/portable", mul_wide_hi, reps);
+    bench_binop("barrett_mul/portable", barrett_mul, reps);
+    bench_binop("mont_mul/portable", mont_mul, reps);
+    bench_binop("modexp_ct/portable", modexp_ct, reps / 200 + 1);
+    uint256_use_adx(1);
+  }
+
+  bench_operands("small", small_val, reps);
+  bench_operands("full", full_val, reps);
+  bench_operands("density", density_val, reps);
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+#ifndef UINT256_INLINE_H
+#define UINT256_INLINE_H
+
+// Header-only versions of the cheap UInt256 operations, for callers
+// that want them inlined into their own loops. Each has the same
+// semantics as the corresponding _to function in uint256.h: operands
+// are read in full before dst is written, so dst may alias either
+// operand (or both).
+
+#include <string.h>
+#include "uint256.h"
+
+// Private helpers for the functions below. They repeat the limb
+// helpers that uint256.c uses internally, so that this header does
+// not make those part of the public API.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UINT256_INLINE_LE 1
+#endif
+
+static inline void uint256_inline_load( uint64_t w[4], const UInt256 *val ) {
+  for (int i = 0; i < 4; i++) {
+#ifdef UINT256_INLINE_LE
+    memcpy(&w[i], &val->data[2*i], sizeof(w[i]));
+#else
+    w[i] = (uint64_t) val->data[2*i] | ((uint64_t) val->data[2*i + 1] << 32);
+#endif
+  }
+}
+
+static inline void uint256_inline_store( UInt256 *val, const uint64_t w[4] ) {
+  for (int i = 0; i < 4; i++) {
+#ifdef UINT256_INLINE_LE
+    memcpy(&val->data[2*i], &w[i], sizeof(w[i]));
+#else
+    val->data[2*i] = (uint32_t) w[i];
+    val->data[2*i + 1] = (uint32_t) (w[i] >> 32);
+#endif
+  }
+}
+
+// Add-with-carry / subtract-with-borrow on 64-bit limbs. On x86-64
+// these use the compiler's adc/sbb builtins directly (the intrinsic
+// headers would be pulled into every includer otherwise); elsewhere
+// the carry is recovered from wraparound comparisons.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(UINT256_PORTABLE)
+static inline uint64_t uint256_inline_addc( uint64_t a, uint64_t b, unsigned char cin, unsigned char *cout ) {
+  unsigned long long r;
+  *cout = __builtin_ia32_addcarryx_u64(cin, a, b, &r);
+  return r;
+}
+
+static inline uint64_t uint256_inline_subb( uint64_t a, uint64_t b, unsigned char bin, unsigned char *bout ) {
+  unsigned long long r;
+#ifdef __clang__
+  *bout = __builtin_ia32_subborrow_u64(bin, a, b, &r);
+#else
+  *bout = __builtin_ia32_sbb_u64(bin, a, b, &r);
+#endif
+  return r;
+}
+#else
+static inline uint64_t uint256_inline_addc( uint64_t a, uint64_t b, unsigned char cin, unsigned char *cout ) {
+  uint64_t s = a + b;
+  uint64_t r = s + cin;
+  *cout = (unsigned char) ((s < a) | (r < s));
+  return r;
+}
+
+static inline uint64_t uint256_inline_subb( uint64_t a, uint64_t b, unsigned char bin, unsigned char *bout ) {
+  uint64_t d = a - b;
+  uint64_t r = d - bin;
+  *bout = (unsigned char) ((a < b) | (d < bin));
+  return r;
+}
+#endif
+
+// dst = a + b
+static inline void uint256_add_inline( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint64_t x[4], y[4], s[4];
+  unsigned char carry = 0;
+  uint256_inline_load(x, a);
+  uint256_inline_load(y, b);
+  //single carry chain across the four limbs, the final carry is dropped
+  s[0] = uint256_inline_addc(x[0], y[0], carry, &carry);
+  s[1] = uint256_inline_addc(x[1], y[1], carry, &carry);
+  s[2] = uint256_inline_addc(x[2], y[2], carry, &carry);
+  s[3] = uint256_inline_addc(x[3], y[3], carry, &carry);
+  uint256_inline_store(dst, s);
+}
+
+// dst = a - b
+static inline void uint256_sub_inline( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  uint64_t x[4], y[4], d[4];
+  unsigned char borrow = 0;
+  uint256_inline_load(x, a);
+  uint256_inline_load(y, b);
+  //direct borrow chain, same result as a + -b without the extra pass
+  d[0] = uint256_inline_subb(x[0], y[0], borrow, &borrow);
+  d[1] = uint256_inline_subb(x[1], y[1], borrow, &borrow);
+  d[2] = uint256_inline_subb(x[2], y[2], borrow, &borrow);
+  d[3] = uint256_inline_subb(x[3], y[3], borrow, &borrow);
+  uint256_inline_store(dst, d);
+}
+
+// dst = -a (two's complement)
+static inline void uint256_negate_inline( UInt256 *dst, const UInt256 *a ) {
+  uint64_t x[4], n[4];
+  unsigned char borrow = 0;
+  uint256_inline_load(x, a);
+  //-a == 0 - a
+  n[0] = uint256_inline_subb(0, x[0], borrow, &borrow);
+  n[1] = uint256_inline_subb(0, x[1], borrow, &borrow);
+  n[2] = uint256_inline_subb(0, x[2], borrow, &borrow);
+  n[3] = uint256_inline_subb(0, x[3], borrow, &borrow);
+  uint256_inline_store(dst, n);
+}
+
+// dst = a & b, a | b, a ^ b and ~a. The words are independent, so
+// these work on the data array directly.
+static inline void uint256_and_inline( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (int i = 0; i < 8; i++) {
+    dst->data[i] = a->data[i] & b->data[i];
+  }
+}
+
+static inline void uint256_or_inline( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (int i = 0; i < 8; i++) {
+    dst->data[i] = a->data[i] | b->data[i];
+  }
+}
+
+static inline void uint256_xor_inline( UInt256 *dst, const UInt256 *a, const UInt256 *b ) {
+  for (int i = 0; i < 8; i++) {
+    dst->data[i] = a->data[i] ^ b->data[i];
+  }
+}
+
+static inline void uint256_not_inline( UInt256 *dst, const UInt256 *a ) {
+  for (int i = 0; i < 8; i++) {
+    dst->data[i] = ~a->data[i];
+  }
+}
+
+// Same result as uint256_cmp( *a, *b ).
+static inline int uint256_cmp_inline( const UInt256 *a, const UInt256 *b ) {
+  uint64_t x[4], y[4];
+  uint256_inline_load(x, a);
+  uint256_inline_load(y, b);
+  for (int i = 3; i >= 0; i--) {
+    if (x[i] != y[i]) {
+      return x[i] < y[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+#endif // UINT256_INLINE_H
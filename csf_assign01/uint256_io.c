@@ -0,0 +1,259 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "uint256_io.h"
+#include "uint256_limb.h"
+
+_Static_assert(sizeof(UInt256) == UINT256_BYTES, "UInt256 must be exactly 32 bytes");
+_Static_assert(sizeof(UInt256FileHeader) == 32, "the file header must be 32 bytes");
+
+// Values converted per write call by uint256_write_file
+#define WRITE_CHUNK 1024
+
+// Byte order conversions of a single word. UINT256_LIMBS_NATIVE
+// marks a little-endian host; anything else is taken to be
+// big-endian.
+static inline uint64_t be64( uint64_t x ) {
+#ifdef UINT256_LIMBS_NATIVE
+  return __builtin_bswap64(x);
+#else
+  return x;
+#endif
+}
+
+static inline uint64_t le64( uint64_t x ) {
+#ifdef UINT256_LIMBS_NATIVE
+  return x;
+#else
+  return __builtin_bswap64(x);
+#endif
+}
+
+static inline uint32_t le32( uint32_t x ) {
+#ifdef UINT256_LIMBS_NATIVE
+  return x;
+#else
+  return __builtin_bswap32(x);
+#endif
+}
+
+#ifdef UINT256_X86_INTRIN
+#define IO_AVX2 __attribute__((target("avx2")))
+
+// Reverse the 32 bytes of each of n values, which converts between
+// the in-memory layout and big-endian bytes in either direction:
+// vpshufb reverses the bytes within each 128-bit half, and vpermq
+// swaps the halves.
+IO_AVX2 static void reverse_bytes_avx2( uint8_t *out, const uint8_t *in, size_t n ) {
+  const __m256i rev = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+                                       15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+  for (size_t i = 0; i < n; i++) {
+    __m256i x = _mm256_loadu_si256((const __m256i *) (in + i * UINT256_BYTES));
+    x = _mm256_shuffle_epi8(x, rev);
+    x = _mm256_permute4x64_epi64(x, 0x4e);
+    _mm256_storeu_si256((__m256i *) (out + i * UINT256_BYTES), x);
+  }
+}
+#endif
+
+// Return 1 if the byte-order conversions use the AVX2 path on this
+// machine, 0 if they use the scalar code.
+int uint256_io_simd( void ) {
+#ifdef UINT256_X86_INTRIN
+  return __builtin_cpu_supports("avx2");
+#else
+  return 0;
+#endif
+}
+
+// Bulk conversion between n values and n * UINT256_BYTES bytes of
+// big-endian (most significant byte first) or little-endian data.
+// The byte buffers need no particular alignment, and must not
+// overlap the value arrays.
+void uint256_encode_be( uint8_t *out, const UInt256 *vals, size_t n ) {
+#ifdef UINT256_X86_INTRIN
+  if (uint256_io_simd()) {
+    reverse_bytes_avx2(out, (const uint8_t *) vals, n);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w[4];
+    limbs_load(w, &vals[i]);
+    //most significant limb first, each one byte-swapped
+    for (int j = 0; j < 4; j++) {
+      uint64_t x = be64(w[3 - j]);
+      memcpy(out + i * UINT256_BYTES + 8 * j, &x, sizeof(x));
+    }
+  }
+}
+
+void uint256_decode_be( UInt256 *vals, const uint8_t *in, size_t n ) {
+#ifdef UINT256_X86_INTRIN
+  if (uint256_io_simd()) {
+    reverse_bytes_avx2((uint8_t *) vals, in, n);
+    return;
+  }
+#endif
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w[4];
+    for (int j = 0; j < 4; j++) {
+      uint64_t x;
+      memcpy(&x, in + i * UINT256_BYTES + 8 * j, sizeof(x));
+      w[3 - j] = be64(x);
+    }
+    limbs_store(&vals[i], w);
+  }
+}
+
+void uint256_encode_le( uint8_t *out, const UInt256 *vals, size_t n ) {
+#ifdef UINT256_LIMBS_NATIVE
+  //already the in-memory layout
+  memcpy(out, vals, n * UINT256_BYTES);
+#else
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w[4];
+    limbs_load(w, &vals[i]);
+    for (int j = 0; j < 4; j++) {
+      uint64_t x = le64(w[j]);
+      memcpy(out + i * UINT256_BYTES + 8 * j, &x, sizeof(x));
+    }
+  }
+#endif
+}
+
+void uint256_decode_le( UInt256 *vals, const uint8_t *in, size_t n ) {
+#ifdef UINT256_LIMBS_NATIVE
+  memcpy(vals, in, n * UINT256_BYTES);
+#else
+  for (size_t i = 0; i < n; i++) {
+    uint64_t w[4];
+    for (int j = 0; j < 4; j++) {
+      memcpy(&w[j], in + i * UINT256_BYTES + 8 * j, sizeof(w[j]));
+      w[j] = le64(w[j]);
+    }
+    limbs_store(&vals[i], w);
+  }
+#endif
+}
+
+// Write n values to a new file at path (replacing any existing
+// one) in the given order. Returns 1 on success, or 0 with errno
+// set if the file could not be written.
+int uint256_write_file( const char *path, const UInt256 *vals, size_t n, UInt256ByteOrder order ) {
+  UInt256FileHeader hdr;
+  uint8_t buf[WRITE_CHUNK * UINT256_BYTES];
+  memcpy(hdr.magic, UINT256_FILE_MAGIC, sizeof(hdr.magic));
+  hdr.version = le32(UINT256_FILE_VERSION);
+  hdr.order = le32(order);
+  hdr.count = le64(n);
+  hdr.reserved = 0;
+
+  FILE *out = fopen(path, "wb");
+  if (!out) {
+    return 0;
+  }
+  int ok = fwrite(&hdr, sizeof(hdr), 1, out) == 1;
+  for (size_t i = 0; ok && i < n; i += WRITE_CHUNK) {
+    size_t chunk = n - i < WRITE_CHUNK ? n - i : WRITE_CHUNK;
+    if (order == UINT256_ORDER_BE_BYTES) {
+      uint256_encode_be(buf, vals + i, chunk);
+    } else {
+      uint256_encode_le(buf, vals + i, chunk);
+    }
+    ok = fwrite(buf, UINT256_BYTES, chunk, out) == chunk;
+  }
+  //fclose flushes, so its result counts too
+  if (fclose(out) != 0) {
+    ok = 0;
+  }
+  return ok;
+}
+
+// Open the array file at path. A file in the host's own order is
+// memory-mapped and used in place: vals points into the mapping and
+// nothing is copied. A file in the other order is decoded once into
+// an allocated array. Returns 1 on success, or 0 (with fm cleared)
+// if the file can't be opened or isn't a well-formed array file.
+int uint256_map_file( UInt256FileMap *fm, const char *path ) {
+  struct stat st;
+  UInt256FileHeader hdr;
+  memset(fm, 0, sizeof(*fm));
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return 0;
+  }
+  size_t len = (size_t) st.st_size;
+  if (len < sizeof(hdr)) {
+    close(fd);
+    errno = EINVAL;
+    return 0;
+  }
+  void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return 0;
+  }
+
+  //the size must match the header's count exactly
+  memcpy(&hdr, map, sizeof(hdr));
+  uint32_t order = le32(hdr.order);
+  uint64_t count = le64(hdr.count);
+  size_t body = len - sizeof(hdr);
+  if (memcmp(hdr.magic, UINT256_FILE_MAGIC, sizeof(hdr.magic)) != 0
+      || le32(hdr.version) != UINT256_FILE_VERSION
+      || (order != UINT256_ORDER_LE_LIMBS && order != UINT256_ORDER_BE_BYTES)
+      || hdr.reserved != 0
+      || body % UINT256_BYTES != 0 || body / UINT256_BYTES != count) {
+    munmap(map, len);
+    errno = EINVAL;
+    return 0;
+  }
+  const uint8_t *data = (const uint8_t *) map + sizeof(hdr);
+
+#ifdef UINT256_LIMBS_NATIVE
+  if (order == UINT256_ORDER_LE_LIMBS) {
+    //the mapping is page-aligned and the header a multiple of the
+    //value size, so the values are suitably aligned in place
+    fm->vals = (const UInt256 *) data;
+    fm->count = (size_t) count;
+    fm->map = map;
+    fm->map_len = len;
+    return 1;
+  }
+#endif
+
+  UInt256 *copy = malloc(count > 0 ? (size_t) count * sizeof(UInt256) : 1);
+  if (!copy) {
+    munmap(map, len);
+    return 0;
+  }
+  if (order == UINT256_ORDER_BE_BYTES) {
+    uint256_decode_be(copy, data, (size_t) count);
+  } else {
+    uint256_decode_le(copy, data, (size_t) count);
+  }
+  munmap(map, len);
+  fm->vals = copy;
+  fm->count = (size_t) count;
+  fm->copy = copy;
+  return 1;
+}
+
+// Release the view; fm->vals is invalid afterwards.
+void uint256_unmap_file( UInt256FileMap *fm ) {
+  if (fm->map) {
+    munmap(fm->map, fm->map_len);
+  }
+  free(fm->copy);
+  memset(fm, 0, sizeof(*fm));
+}
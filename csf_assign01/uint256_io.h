@@ -0,0 +1,81 @@
+#ifndef UINT256_IO_H
+#define UINT256_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "uint256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary layout of a UInt256 array file: a 32-byte header followed
+// by count values of UINT256_BYTES bytes each, with nothing after
+// them. The header fields are little-endian. The values are stored
+// in one of two orders:
+//
+//   UINT256_ORDER_LE_LIMBS  least significant byte first, which is
+//                           the in-memory UInt256 layout on
+//                           little-endian hosts, so the file can be
+//                           used in place
+//   UINT256_ORDER_BE_BYTES  most significant byte first, the usual
+//                           network/big-number interchange order
+#define UINT256_BYTES 32
+#define UINT256_FILE_MAGIC "UINT256\n"
+#define UINT256_FILE_VERSION 1
+
+typedef enum {
+  UINT256_ORDER_LE_LIMBS = 0,
+  UINT256_ORDER_BE_BYTES = 1,
+} UInt256ByteOrder;
+
+typedef struct {
+  char magic[8];      // UINT256_FILE_MAGIC, without a terminating NUL
+  uint32_t version;   // UINT256_FILE_VERSION
+  uint32_t order;     // a UInt256ByteOrder
+  uint64_t count;     // number of values that follow
+  uint64_t reserved;  // zero
+} UInt256FileHeader;
+
+// Bulk conversion between n values and n * UINT256_BYTES bytes of
+// big-endian (most significant byte first) or little-endian data.
+// The byte buffers need no particular alignment, and must not
+// overlap the value arrays.
+void uint256_encode_be( uint8_t *out, const UInt256 *vals, size_t n );
+void uint256_decode_be( UInt256 *vals, const uint8_t *in, size_t n );
+void uint256_encode_le( uint8_t *out, const UInt256 *vals, size_t n );
+void uint256_decode_le( UInt256 *vals, const uint8_t *in, size_t n );
+
+// Write n values to a new file at path (replacing any existing
+// one) in the given order. Returns 1 on success, or 0 with errno
+// set if the file could not be written.
+int uint256_write_file( const char *path, const UInt256 *vals, size_t n, UInt256ByteOrder order );
+
+// A read-only view of a UInt256 array file.
+typedef struct {
+  const UInt256 *vals;  // the values
+  size_t count;         // number of values
+  void *map;            // the file mapping, or NULL
+  size_t map_len;       // length of the mapping
+  UInt256 *copy;        // decoded copy of the values, or NULL
+} UInt256FileMap;
+
+// Open the array file at path. A file in the host's own order is
+// memory-mapped and used in place: vals points into the mapping and
+// nothing is copied. A file in the other order is decoded once into
+// an allocated array. Returns 1 on success, or 0 (with fm cleared)
+// if the file can't be opened or isn't a well-formed array file.
+int uint256_map_file( UInt256FileMap *fm, const char *path );
+
+// Release the view; fm->vals is invalid afterwards.
+void uint256_unmap_file( UInt256FileMap *fm );
+
+// Return 1 if the byte-order conversions use the AVX2 path on this
+// machine, 0 if they use the scalar code.
+int uint256_io_simd( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UINT256_IO_H
@@ -0,0 +1,649 @@
+#ifndef UINT256_LIMB_H
+#define UINT256_LIMB_H
+
+// Internal 64-bit limb primitives shared by the UInt256 library
+// sources. Not part of the public API.
+
+#include <stdint.h>
+#include <string.h>
+#include "uint256.h"
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(UINT256_PORTABLE)
+#include <x86intrin.h>
+#define UINT256_X86_INTRIN 1
+#endif
+
+// Add-with-carry / subtract-with-borrow on 64-bit limbs.
+// On x86-64 these map straight onto adc/sbb via the compiler
+// intrinsics; elsewhere (or when built with -DUINT256_PORTABLE)
+// the carry is recovered from unsigned wraparound comparisons,
+// which compilers lower to setc/sbb rather than branches.
+#ifdef UINT256_X86_INTRIN
+static inline uint64_t limb_addc( uint64_t a, uint64_t b, unsigned char cin, unsigned char *cout ) {
+  unsigned long long r;
+  *cout = _addcarry_u64(cin, a, b, &r);
+  return r;
+}
+
+static inline uint64_t limb_subb( uint64_t a, uint64_t b, unsigned char bin, unsigned char *bout ) {
+  unsigned long long r;
+  *bout = _subborrow_u64(bin, a, b, &r);
+  return r;
+}
+#else
+static inline uint64_t limb_addc( uint64_t a, uint64_t b, unsigned char cin, unsigned char *cout ) {
+  uint64_t s = a + b;
+  uint64_t r = s + cin;
+  *cout = (unsigned char) ((s < a) | (r < s));
+  return r;
+}
+
+static inline uint64_t limb_subb( uint64_t a, uint64_t b, unsigned char bin, unsigned char *bout ) {
+  uint64_t d = a - b;
+  uint64_t r = d - bin;
+  *bout = (unsigned char) ((a < b) | (d < bin));
+  return r;
+}
+#endif
+
+// View the eight 32-bit words of a UInt256 as four 64-bit limbs
+// (limb 0 least significant). On little-endian targets each pair of
+// words already is a limb, so it is copied with one 64-bit move; the
+// shift-and-or form is kept for other byte orders. (GCC vectorizes
+// the shift form into a shuffle sequence instead of fusing it into
+// 64-bit loads, which costs more than the add it feeds.)
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define UINT256_LIMBS_NATIVE 1
+#endif
+
+static inline void limbs_load( uint64_t w[4], const UInt256 *val ) {
+#ifdef UINT256_LIMBS_NATIVE
+  for (int i = 0; i < 4; i++) {
+    memcpy(&w[i], &val->data[2*i], sizeof(w[i]));
+  }
+#else
+  for (int i = 0; i < 4; i++) {
+    w[i] = (uint64_t) val->data[2*i] | ((uint64_t) val->data[2*i + 1] << 32);
+  }
+#endif
+}
+
+static inline void limbs_store( UInt256 *val, const uint64_t w[4] ) {
+#ifdef UINT256_LIMBS_NATIVE
+  for (int i = 0; i < 4; i++) {
+    memcpy(&val->data[2*i], &w[i], sizeof(w[i]));
+  }
+#else
+  for (int i = 0; i < 4; i++) {
+    val->data[2*i] = (uint32_t) w[i];
+    val->data[2*i + 1] = (uint32_t) (w[i] >> 32);
+  }
+#endif
+}
+
+// Same as limbs_load/limbs_store, for the eight limbs of a UInt512.
+static inline void wide_load( uint64_t w[8], const UInt512 *val ) {
+#ifdef UINT256_LIMBS_NATIVE
+  for (int i = 0; i < 8; i++) {
+    memcpy(&w[i], &val->data[2*i], sizeof(w[i]));
+  }
+#else
+  for (int i = 0; i < 8; i++) {
+    w[i] = (uint64_t) val->data[2*i] | ((uint64_t) val->data[2*i + 1] << 32);
+  }
+#endif
+}
+
+static inline void wide_store( UInt512 *val, const uint64_t w[8] ) {
+#ifdef UINT256_LIMBS_NATIVE
+  for (int i = 0; i < 8; i++) {
+    memcpy(&val->data[2*i], &w[i], sizeof(w[i]));
+  }
+#else
+  for (int i = 0; i < 8; i++) {
+    val->data[2*i] = (uint32_t) w[i];
+    val->data[2*i + 1] = (uint32_t) (w[i] >> 32);
+  }
+#endif
+}
+
+// Full 64x64->128 bit limb product, returning the low word and
+// storing the high word through hi.
+#ifdef __SIZEOF_INT128__
+__extension__ typedef unsigned __int128 uint128_t;
+
+static inline uint64_t limb_mul( uint64_t a, uint64_t b, uint64_t *hi ) {
+  uint128_t p = (uint128_t) a * b;
+  *hi = (uint64_t) (p >> 64);
+  return (uint64_t) p;
+}
+#else
+static inline uint64_t limb_mul( uint64_t a, uint64_t b, uint64_t *hi ) {
+  uint64_t a_lo = (uint32_t) a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t) b, b_hi = b >> 32;
+  uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi;
+  uint64_t hl = a_hi * b_lo, hh = a_hi * b_hi;
+  uint64_t mid = (ll >> 32) + (uint32_t) lh + (uint32_t) hl;
+  *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+  return (mid << 32) | (uint32_t) ll;
+}
+#endif
+
+// Compute a*b + t + c as a 128-bit value, returning the low word and
+// storing the high word through hi. Cannot overflow: the largest
+// possible result is exactly 2^128 - 1.
+#ifdef __SIZEOF_INT128__
+static inline uint64_t limb_mac( uint64_t a, uint64_t b, uint64_t t, uint64_t c, uint64_t *hi ) {
+  uint128_t p = (uint128_t) a * b + t + c;
+  *hi = (uint64_t) (p >> 64);
+  return (uint64_t) p;
+}
+#else
+static inline uint64_t limb_mac( uint64_t a, uint64_t b, uint64_t t, uint64_t c, uint64_t *hi ) {
+  unsigned char carry;
+  uint64_t phi, lo = limb_mul(a, b, &phi);
+  lo = limb_addc(lo, t, 0, &carry);
+  phi += carry;
+  lo = limb_addc(lo, c, 0, &carry);
+  *hi = phi + carry;
+  return lo;
+}
+#endif
+
+// Number of leading zero bits in a nonzero limb.
+static inline int limb_clz( uint64_t w ) {
+#ifdef __GNUC__
+  return __builtin_clzll(w);
+#else
+  int n = 0;
+  for (uint64_t bit = (uint64_t) 1 << 63; !(w & bit); bit >>= 1) {
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Number of trailing zero bits in a nonzero limb.
+static inline int limb_ctz( uint64_t w ) {
+#ifdef __GNUC__
+  return __builtin_ctzll(w);
+#else
+  int n = 0;
+  for (uint64_t bit = 1; !(w & bit); bit <<= 1) {
+    n++;
+  }
+  return n;
+#endif
+}
+
+// Number of set bits in a limb. __builtin_popcountll is only a
+// single instruction when the target has popcnt (e.g. -mpopcnt);
+// otherwise it is a libgcc call, so the SWAR sum is inlined instead.
+static inline int limb_popcount( uint64_t w ) {
+#if defined(__GNUC__) && defined(__POPCNT__)
+  return __builtin_popcountll(w);
+#else
+  w = w - ((w >> 1) & 0x5555555555555555ULL);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (int) ((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// Divide the 128-bit value hi:lo by d, returning the quotient and
+// storing the remainder through rem. Requires hi < d, so that the
+// quotient fits in one limb.
+#ifdef UINT256_X86_INTRIN
+static inline uint64_t limb_div( uint64_t hi, uint64_t lo, uint64_t d, uint64_t *rem ) {
+  uint64_t q, r;
+  __asm__("divq %4" : "=a"(q), "=d"(r) : "a"(lo), "d"(hi), "rm"(d));
+  *rem = r;
+  return q;
+}
+#elif defined(__SIZEOF_INT128__)
+static inline uint64_t limb_div( uint64_t hi, uint64_t lo, uint64_t d, uint64_t *rem ) {
+  uint128_t n = ((uint128_t) hi << 64) | lo;
+  uint64_t q = (uint64_t) (n / d);
+  *rem = lo - q * d;
+  return q;
+}
+#else
+// Schoolbook 2-by-1 division on 32-bit half-limbs
+// (Hacker's Delight, divlu).
+static inline uint64_t limb_div( uint64_t hi, uint64_t lo, uint64_t d, uint64_t *rem ) {
+  const uint64_t b = (uint64_t) 1 << 32;
+  int s = limb_clz(d);
+  d <<= s;
+  uint64_t dn1 = d >> 32, dn0 = (uint32_t) d;
+  uint64_t un32 = s ? (hi << s) | (lo >> (64 - s)) : hi;
+  uint64_t un10 = lo << s;
+  uint64_t un1 = un10 >> 32, un0 = (uint32_t) un10;
+
+  uint64_t q1 = un32 / dn1, rhat = un32 - q1 * dn1;
+  while (q1 >= b || q1 * dn0 > b * rhat + un1) {
+    q1--;
+    rhat += dn1;
+    if (rhat >= b) {
+      break;
+    }
+  }
+  uint64_t un21 = un32 * b + un1 - q1 * d;
+
+  uint64_t q0 = un21 / dn1;
+  rhat = un21 - q0 * dn1;
+  while (q0 >= b || q0 * dn0 > b * rhat + un0) {
+    q0--;
+    rhat += dn1;
+    if (rhat >= b) {
+      break;
+    }
+  }
+  *rem = (un21 * b + un0 - q0 * d) >> s;
+  return q1 * b + q0;
+}
+#endif
+
+// Comba column accumulator: (c0, c1, c2) holds the running sum of
+// one output column plus whatever carried in from the previous one.
+typedef struct {
+  uint64_t c0, c1, c2;
+} Column;
+
+// Add a*b into the column.
+static inline void col_mac( Column *col, uint64_t a, uint64_t b ) {
+  uint64_t hi, lo = limb_mul(a, b, &hi);
+  unsigned char carry;
+  col->c0 = limb_addc(col->c0, lo, 0, &carry);
+  col->c1 = limb_addc(col->c1, hi, carry, &carry);
+  col->c2 += carry;
+}
+
+// Add 2*a*b into the column (the off-diagonal terms of a square).
+static inline void col_mac2( Column *col, uint64_t a, uint64_t b ) {
+  uint64_t hi, lo = limb_mul(a, b, &hi);
+  unsigned char carry;
+  col->c2 += hi >> 63;
+  hi = (hi << 1) | (lo >> 63);
+  lo <<= 1;
+  col->c0 = limb_addc(col->c0, lo, 0, &carry);
+  col->c1 = limb_addc(col->c1, hi, carry, &carry);
+  col->c2 += carry;
+}
+
+// Finish the current column: return its low word and carry the
+// rest into the next column.
+static inline uint64_t col_next( Column *col ) {
+  uint64_t out = col->c0;
+  col->c0 = col->c1;
+  col->c1 = col->c2;
+  col->c2 = 0;
+  return out;
+}
+
+// Low 256 bits of the product of two 4-limb values. The top column
+// only contributes its low word, so it is summed with plain
+// wrapping multiplies.
+static inline void limbs_mul_lo( uint64_t r[4], const uint64_t a[4], const uint64_t b[4] ) {
+  Column col = {0, 0, 0};
+  col_mac(&col, a[0], b[0]);
+  r[0] = col_next(&col);
+  col_mac(&col, a[0], b[1]);
+  col_mac(&col, a[1], b[0]);
+  r[1] = col_next(&col);
+  col_mac(&col, a[0], b[2]);
+  col_mac(&col, a[1], b[1]);
+  col_mac(&col, a[2], b[0]);
+  r[2] = col_next(&col);
+  r[3] = col.c0 + a[0] * b[3] + a[1] * b[2] + a[2] * b[1] + a[3] * b[0];
+}
+
+// Full 512-bit product of two 4-limb values, same column kernel
+// as limbs_mul_lo carried through all eight columns.
+static inline void limbs_mul_wide( uint64_t r[8], const uint64_t a[4], const uint64_t b[4] ) {
+  Column col = {0, 0, 0};
+  col_mac(&col, a[0], b[0]);
+  r[0] = col_next(&col);
+  col_mac(&col, a[0], b[1]);
+  col_mac(&col, a[1], b[0]);
+  r[1] = col_next(&col);
+  col_mac(&col, a[0], b[2]);
+  col_mac(&col, a[1], b[1]);
+  col_mac(&col, a[2], b[0]);
+  r[2] = col_next(&col);
+  col_mac(&col, a[0], b[3]);
+  col_mac(&col, a[1], b[2]);
+  col_mac(&col, a[2], b[1]);
+  col_mac(&col, a[3], b[0]);
+  r[3] = col_next(&col);
+  col_mac(&col, a[1], b[3]);
+  col_mac(&col, a[2], b[2]);
+  col_mac(&col, a[3], b[1]);
+  r[4] = col_next(&col);
+  col_mac(&col, a[2], b[3]);
+  col_mac(&col, a[3], b[2]);
+  r[5] = col_next(&col);
+  col_mac(&col, a[3], b[3]);
+  r[6] = col_next(&col);
+  r[7] = col.c0;
+}
+
+// Low 256 bits of the square of a 4-limb value. Each off-diagonal
+// product a[i]*a[j] appears twice, so it is computed once and doubled.
+static inline void limbs_sqr_lo( uint64_t r[4], const uint64_t a[4] ) {
+  Column col = {0, 0, 0};
+  col_mac(&col, a[0], a[0]);
+  r[0] = col_next(&col);
+  col_mac2(&col, a[0], a[1]);
+  r[1] = col_next(&col);
+  col_mac2(&col, a[0], a[2]);
+  col_mac(&col, a[1], a[1]);
+  r[2] = col_next(&col);
+  r[3] = col.c0 + ((a[0] * a[3] + a[1] * a[2]) << 1);
+}
+
+// Full 512-bit square of a 4-limb value.
+static inline void limbs_sqr_wide( uint64_t r[8], const uint64_t a[4] ) {
+  Column col = {0, 0, 0};
+  col_mac(&col, a[0], a[0]);
+  r[0] = col_next(&col);
+  col_mac2(&col, a[0], a[1]);
+  r[1] = col_next(&col);
+  col_mac2(&col, a[0], a[2]);
+  col_mac(&col, a[1], a[1]);
+  r[2] = col_next(&col);
+  col_mac2(&col, a[0], a[3]);
+  col_mac2(&col, a[1], a[2]);
+  r[3] = col_next(&col);
+  col_mac2(&col, a[1], a[3]);
+  col_mac(&col, a[2], a[2]);
+  r[4] = col_next(&col);
+  col_mac2(&col, a[2], a[3]);
+  r[5] = col_next(&col);
+  col_mac(&col, a[3], a[3]);
+  r[6] = col_next(&col);
+  r[7] = col.c0;
+}
+
+#ifdef UINT256_X86_INTRIN
+// Set at startup (in uint256.c) when the CPU has BMI2 and ADX, which
+// selects the kernels below over the portable limb code. Those run
+// two carry chains at once: mulx multiplies without touching the
+// flags, adcx carries through CF only and adox through OF only, so
+// the low halves of a row of products go down one chain while the
+// high halves go down the other. GCC doesn't emit adox itself, hence
+// the inline assembly; the instructions assemble for any target, and
+// the flag keeps them from running where they don't exist.
+extern int limbs_have_adx;
+
+// One row of a product: x0..x4 += a * rdx, with the top limb x4
+// written (not added to) by the last mulx. zero must be cleared
+// first, which also clears CF and OF.
+#define ADX_ROW(x0, x1, x2, x3, x4) \
+  "mulxq 0(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" x0 "]\n\t" \
+  "adoxq %[hi], %[" x1 "]\n\t" \
+  "mulxq 8(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" x1 "]\n\t" \
+  "adoxq %[hi], %[" x2 "]\n\t" \
+  "mulxq 16(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" x2 "]\n\t" \
+  "adoxq %[hi], %[" x3 "]\n\t" \
+  "mulxq 24(%[a]), %[lo], %[" x4 "]\n\t" \
+  "adcxq %[lo], %[" x3 "]\n\t" \
+  "adoxq %[zero], %[" x4 "]\n\t" \
+  "adcxq %[zero], %[" x4 "]\n\t"
+
+// Same result as limbs_mul_wide.
+static inline void limbs_mul_wide_adx( uint64_t r[8], const uint64_t a[4], const uint64_t b[4] ) {
+  uint64_t r0, r1, r2, r3, r4, r5, r6, r7, lo, hi, zero;
+  __asm__(
+    //first row straight into r0..r4
+    "movq 0(%[b]), %%rdx\n\t"
+    "mulxq 0(%[a]), %[r0], %[r1]\n\t"
+    "mulxq 8(%[a]), %[lo], %[r2]\n\t"
+    "addq %[lo], %[r1]\n\t"
+    "mulxq 16(%[a]), %[lo], %[r3]\n\t"
+    "adcq %[lo], %[r2]\n\t"
+    "mulxq 24(%[a]), %[lo], %[r4]\n\t"
+    "adcq %[lo], %[r3]\n\t"
+    "adcq $0, %[r4]\n\t"
+    "movq 8(%[b]), %%rdx\n\t"
+    "xorl %k[zero], %k[zero]\n\t"
+    ADX_ROW("r1", "r2", "r3", "r4", "r5")
+    "movq 16(%[b]), %%rdx\n\t"
+    "xorl %k[zero], %k[zero]\n\t"
+    ADX_ROW("r2", "r3", "r4", "r5", "r6")
+    "movq 24(%[b]), %%rdx\n\t"
+    "xorl %k[zero], %k[zero]\n\t"
+    ADX_ROW("r3", "r4", "r5", "r6", "r7")
+    : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2), [r3] "=&r"(r3),
+      [r4] "=&r"(r4), [r5] "=&r"(r5), [r6] "=&r"(r6), [r7] "=&r"(r7),
+      [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero)
+    : [a] "r"(a), [b] "r"(b)
+    : "rdx", "cc", "memory");
+  r[0] = r0;
+  r[1] = r1;
+  r[2] = r2;
+  r[3] = r3;
+  r[4] = r4;
+  r[5] = r5;
+  r[6] = r6;
+  r[7] = r7;
+}
+
+// Same result as limbs_mul_lo. The rows stop at limb 3, and the
+// products that only reach limb 3 need just their low halves, which
+// are summed in C (imul would clobber the carry flags mid-chain).
+static inline void limbs_mul_lo_adx( uint64_t r[4], const uint64_t a[4], const uint64_t b[4] ) {
+  uint64_t r0, r1, r2, r3, lo, hi, zero;
+  __asm__(
+    "movq 0(%[b]), %%rdx\n\t"
+    "mulxq 0(%[a]), %[r0], %[r1]\n\t"
+    "mulxq 8(%[a]), %[lo], %[r2]\n\t"
+    "addq %[lo], %[r1]\n\t"
+    "mulxq 16(%[a]), %[lo], %[r3]\n\t"
+    "adcq %[lo], %[r2]\n\t"
+    "adcq $0, %[r3]\n\t"
+    "movq 8(%[b]), %%rdx\n\t"
+    "xorl %k[zero], %k[zero]\n\t"
+    "mulxq 0(%[a]), %[lo], %[hi]\n\t"
+    "adcxq %[lo], %[r1]\n\t"
+    "adoxq %[hi], %[r2]\n\t"
+    "mulxq 8(%[a]), %[lo], %[hi]\n\t"
+    "adcxq %[lo], %[r2]\n\t"
+    "adoxq %[hi], %[r3]\n\t"
+    "adcxq %[zero], %[r3]\n\t"
+    "movq 16(%[b]), %%rdx\n\t"
+    "mulxq 0(%[a]), %[lo], %[hi]\n\t"
+    "addq %[lo], %[r2]\n\t"
+    "adcq %[hi], %[r3]\n\t"
+    : [r0] "=&r"(r0), [r1] "=&r"(r1), [r2] "=&r"(r2), [r3] "=&r"(r3),
+      [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero)
+    : [a] "r"(a), [b] "r"(b)
+    : "rdx", "cc", "memory");
+  r[0] = r0;
+  r[1] = r1;
+  r[2] = r2;
+  r[3] = r3 + a[3] * b[0] + a[2] * b[1] + a[1] * b[2] + a[0] * b[3];
+}
+#endif
+
+// limbs_mul_lo and limbs_mul_wide through the ADX kernels when the
+// CPU has them.
+static inline void limbs_mul_lo_dispatch( uint64_t r[4], const uint64_t a[4], const uint64_t b[4] ) {
+#ifdef UINT256_X86_INTRIN
+  if (limbs_have_adx) {
+    limbs_mul_lo_adx(r, a, b);
+    return;
+  }
+#endif
+  limbs_mul_lo(r, a, b);
+}
+
+static inline void limbs_mul_wide_dispatch( uint64_t r[8], const uint64_t a[4], const uint64_t b[4] ) {
+#ifdef UINT256_X86_INTRIN
+  if (limbs_have_adx) {
+    limbs_mul_wide_adx(r, a, b);
+    return;
+  }
+#endif
+  limbs_mul_wide(r, a, b);
+}
+
+// Number of limbs up to and including the most significant nonzero
+// one, out of the n limbs in w.
+static inline int limbs_used( const uint64_t *w, int n ) {
+  while (n > 0 && w[n - 1] == 0) {
+    n--;
+  }
+  return n;
+}
+
+// Number of significant bits in the n-limb value w (0 for zero).
+static inline int limbs_bit_length( const uint64_t *w, int n ) {
+  n = limbs_used(w, n);
+  return n ? n * 64 - limb_clz(w[n - 1]) : 0;
+}
+
+// Number of trailing zero bits in the n-limb value w (64*n for zero).
+static inline int limbs_ctz( const uint64_t *w, int n ) {
+  for (int i = 0; i < n; i++) {
+    if (w[i] != 0) {
+      return i * 64 + limb_ctz(w[i]);
+    }
+  }
+  return n * 64;
+}
+
+// r = a << shift and r = a >> shift on n limbs (0 <= shift <= 64*n),
+// dropping whatever falls off the end; r may alias a. Whole limbs
+// move first, then a single funnel shift joins each pair. Splitting
+// the bit shift into >> 1 and >> (63 - bs) keeps bs == 0
+// well-defined without a branch.
+static inline void limbs_shl( uint64_t *r, const uint64_t *a, int n, int shift ) {
+  int ls = shift / 64, bs = shift % 64;
+  for (int i = n - 1; i >= 0; i--) {
+    uint64_t hi = i >= ls ? a[i - ls] : 0;
+    uint64_t lo = i >= ls + 1 ? a[i - ls - 1] : 0;
+    r[i] = (hi << bs) | ((lo >> 1) >> (63 - bs));
+  }
+}
+
+static inline void limbs_shr( uint64_t *r, const uint64_t *a, int n, int shift ) {
+  int ls = shift / 64, bs = shift % 64;
+  for (int i = 0; i < n; i++) {
+    uint64_t lo = i + ls < n ? a[i + ls] : 0;
+    uint64_t hi = i + ls + 1 < n ? a[i + ls + 1] : 0;
+    r[i] = (lo >> bs) | ((hi << 1) << (63 - bs));
+  }
+}
+
+// Divide the m-limb value u by the single limb d, writing m
+// quotient limbs to q (which may alias u) and returning the
+// remainder.
+static inline uint64_t limbs_divmod_1( uint64_t *q, const uint64_t *u, int m, uint64_t d ) {
+  uint64_t r = 0;
+  for (int i = m - 1; i >= 0; i--) {
+    q[i] = limb_div(r, u[i], d, &r);
+  }
+  return r;
+}
+
+// Binary GCD in word-sized batches (Pornin, "Optimized Binary GCD
+// for Modular Inversion", 2020): GCD_STEPS subtract-and-halve steps
+// run on 64-bit approximations of a and b (their low 31 bits and
+// top 33 bits), with the steps recorded in a matrix that is then
+// applied to the full 4-limb values in one pass. The exact low bits
+// decide every parity test; the top bits decide the comparisons,
+// and the rare wrong one just makes a result negative, which
+// gcd_apply flips back. b must be odd, and stays odd.
+#define GCD_STEPS 31
+
+// a' = (f0*a + g0*b) / 2^GCD_STEPS, b' = (f1*a + g1*b) / 2^GCD_STEPS
+typedef struct {
+  int64_t f0, g0, f1, g1;
+} GcdMatrix;
+
+static inline GcdMatrix gcd_steps( const uint64_t a[4], const uint64_t b[4] ) {
+  uint64_t xa = a[0], xb = b[0];
+  int len = limbs_bit_length(a, 4);
+  int blen = limbs_bit_length(b, 4);
+  len = len > blen ? len : blen;
+  if (len > 64) {
+    //top 33 bits of each (the same bit positions for both), over the
+    //low 31
+    int pos = len - 33, i = pos / 64, s = pos % 64;
+    uint64_t low = ((uint64_t) 1 << 31) - 1;
+    uint64_t ta = (a[i] >> s) | (i < 3 ? (a[i + 1] << 1) << (63 - s) : 0);
+    uint64_t tb = (b[i] >> s) | (i < 3 ? (b[i + 1] << 1) << (63 - s) : 0);
+    xa = (ta << 31) | (a[0] & low);
+    xb = (tb << 31) | (b[0] & low);
+  }
+
+  //each step: if xa is odd, swap so xa >= xb and subtract; then halve
+  //xa. Masks rather than branches, as the outcomes are random.
+  uint64_t f0 = 1, g0 = 0, f1 = 0, g1 = 1;
+  for (int j = 0; j < GCD_STEPS; j++) {
+    uint64_t odd = (uint64_t) 0 - (xa & 1);
+    uint64_t swap = odd & ((uint64_t) 0 - (uint64_t) (xa < xb));
+    uint64_t t = (xa ^ xb) & swap;
+    xa ^= t;
+    xb ^= t;
+    t = (f0 ^ f1) & swap;
+    f0 ^= t;
+    f1 ^= t;
+    t = (g0 ^ g1) & swap;
+    g0 ^= t;
+    g1 ^= t;
+    xa -= xb & odd;
+    f0 -= f1 & odd;
+    g0 -= g1 & odd;
+    xa >>= 1;
+    f1 <<= 1;
+    g1 <<= 1;
+  }
+  GcdMatrix mat = { (int64_t) f0, (int64_t) g0, (int64_t) f1, (int64_t) g1 };
+  return mat;
+}
+
+// r = |f*a + g*b| / 2^GCD_STEPS for the signed factors of a
+// GcdMatrix row (the division is exact). Returns 1 if the sum was
+// negative, so the caller can negate the row to match.
+static inline int gcd_apply( uint64_t r[4], const uint64_t a[4], int64_t f, const uint64_t b[4], int64_t g ) {
+  uint64_t t[5], ca = 0, cb = 0;
+  //a*f + b*g as a five-limb two's complement value: multiply by the
+  //factors as unsigned, then take off a*2^64 (b*2^64) for a negative
+  //f (g)
+  for (int i = 0; i < 4; i++) {
+    t[i] = limb_mac(a[i], (uint64_t) f, 0, ca, &ca);
+    t[i] = limb_mac(b[i], (uint64_t) g, t[i], cb, &cb);
+  }
+  t[4] = ca + cb;
+  uint64_t fneg = (uint64_t) 0 - (uint64_t) (f < 0);
+  uint64_t gneg = (uint64_t) 0 - (uint64_t) (g < 0);
+  unsigned char ba = 0, bb = 0;
+  for (int i = 0; i < 4; i++) {
+    t[i + 1] = limb_subb(t[i + 1], a[i] & fneg, ba, &ba);
+    t[i + 1] = limb_subb(t[i + 1], b[i] & gneg, bb, &bb);
+  }
+
+  int neg = (int) (t[4] >> 63);
+  uint64_t mask = (uint64_t) 0 - (uint64_t) neg;
+  unsigned char carry = (unsigned char) neg;
+  for (int i = 0; i < 4; i++) {
+    uint64_t w = (t[i] >> GCD_STEPS) | (t[i + 1] << (64 - GCD_STEPS));
+    r[i] = limb_addc(w ^ mask, 0, carry, &carry);
+  }
+  return neg;
+}
+
+// Longest dividend limbs_divmod accepts (a 512-bit value plus one
+// limb of headroom).
+#define DIV_MAX_LIMBS 9
+
+// Divide the m-limb u (m <= DIV_MAX_LIMBS) by the 4-limb v (nonzero),
+// writing m quotient limbs to q and 4 remainder limbs to r.
+// Defined in uint256.c.
+void limbs_divmod( uint64_t *q, uint64_t r[4], const uint64_t *u, int m, const uint64_t v[4] );
+
+#endif // UINT256_LIMB_H
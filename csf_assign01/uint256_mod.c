@@ -0,0 +1,713 @@
+#include <assert.h>
+#include "uint256.h"
+#include "uint256_mod.h"
+#include "uint256_limb.h"
+
+// Return t - m if top is set or t >= m, otherwise t. top is the
+// (0 or 1) limb above t. Done with a mask rather than a branch, so
+// the timing does not depend on the values.
+static inline void mod_cond_sub( uint64_t r[4], const uint64_t t[4], uint64_t top, const uint64_t m[4] ) {
+  uint64_t d[4];
+  unsigned char borrow = 0;
+  for (int i = 0; i < 4; i++) {
+    d[i] = limb_subb(t[i], m[i], borrow, &borrow);
+  }
+  //keep t only when the subtraction went negative with no top limb
+  uint64_t keep = (uint64_t) 0 - (uint64_t) (borrow & (top ^ 1));
+  for (int i = 0; i < 4; i++) {
+    r[i] = (t[i] & keep) | (d[i] & ~keep);
+  }
+}
+
+// -m0^-1 mod 2^64 for odd m0, by Newton's iteration: an odd m0 is
+// its own inverse mod 2^3, and each step doubles the number of good
+// bits.
+static inline uint64_t limb_neg_inv( uint64_t m0 ) {
+  uint64_t inv = m0;
+  for (int i = 0; i < 5; i++) {
+    inv *= 2 - m0 * inv;
+  }
+  return (uint64_t) 0 - inv;
+}
+
+// r = a - b mod m for a, b < m: m is added back under a mask when
+// the difference goes negative. r may alias a or b.
+static inline void mod_sub_limbs( uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const uint64_t m[4] ) {
+  unsigned char borrow = 0, carry = 0;
+  for (int i = 0; i < 4; i++) {
+    r[i] = limb_subb(a[i], b[i], borrow, &borrow);
+  }
+  uint64_t mask = (uint64_t) 0 - borrow;
+  for (int i = 0; i < 4; i++) {
+    r[i] = limb_addc(r[i], m[i] & mask, carry, &carry);
+  }
+}
+
+// Montgomery multiplication a*b*R^-1 mod m, in coarsely integrated
+// operand scanning (CIOS) form: each row multiplies in one limb of b
+// and immediately reduces by one limb, so the running value never
+// grows past six limbs. Requires a, b < m.
+static inline void mont_mul_limbs( uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const uint64_t m[4], uint64_t m0inv ) {
+  uint64_t t[6] = {0, 0, 0, 0, 0, 0};
+#pragma GCC unroll 4
+  for (int i = 0; i < 4; i++) {
+    uint64_t c = 0;
+    unsigned char carry;
+
+    //t += a * b[i]
+    for (int j = 0; j < 4; j++) {
+      t[j] = limb_mac(a[j], b[i], t[j], c, &c);
+    }
+    t[4] = limb_addc(t[4], c, 0, &carry);
+    t[5] = carry;
+
+    //t = (t + mq * m) / 2^64, where mq makes the low limb vanish
+    uint64_t mq = t[0] * m0inv;
+    limb_mac(mq, m[0], t[0], 0, &c);
+    for (int j = 1; j < 4; j++) {
+      t[j - 1] = limb_mac(mq, m[j], t[j], c, &c);
+    }
+    t[3] = limb_addc(t[4], c, 0, &carry);
+    t[4] = t[5] + carry;
+  }
+  mod_cond_sub(r, t, t[4], m);
+}
+
+#ifdef UINT256_X86_INTRIN
+// One CIOS row on the ADX chains: multiply a by the limb in rdx into
+// t0..t5, then reduce by one limb of m, which zeroes t0. The row
+// after works on the same registers rotated down by one, so nothing
+// is moved between rows.
+#define MONT_ADX_ROW(b_off, t0, t1, t2, t3, t4, t5) \
+  "movq " b_off "(%[b]), %%rdx\n\t" \
+  "xorl %k[zero], %k[zero]\n\t" \
+  "mulxq 0(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t0 "]\n\t" \
+  "adoxq %[hi], %[" t1 "]\n\t" \
+  "mulxq 8(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t1 "]\n\t" \
+  "adoxq %[hi], %[" t2 "]\n\t" \
+  "mulxq 16(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t2 "]\n\t" \
+  "adoxq %[hi], %[" t3 "]\n\t" \
+  "mulxq 24(%[a]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t3 "]\n\t" \
+  "adoxq %[hi], %[" t4 "]\n\t" \
+  "adcxq %[zero], %[" t4 "]\n\t" \
+  "adoxq %[zero], %[" t5 "]\n\t" \
+  "adcxq %[zero], %[" t5 "]\n\t" \
+  "movq %[" t0 "], %%rdx\n\t" \
+  "imulq %[m0inv], %%rdx\n\t" \
+  "xorl %k[zero], %k[zero]\n\t" \
+  "mulxq 0(%[m]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t0 "]\n\t" \
+  "adoxq %[hi], %[" t1 "]\n\t" \
+  "mulxq 8(%[m]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t1 "]\n\t" \
+  "adoxq %[hi], %[" t2 "]\n\t" \
+  "mulxq 16(%[m]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t2 "]\n\t" \
+  "adoxq %[hi], %[" t3 "]\n\t" \
+  "mulxq 24(%[m]), %[lo], %[hi]\n\t" \
+  "adcxq %[lo], %[" t3 "]\n\t" \
+  "adoxq %[hi], %[" t4 "]\n\t" \
+  "adcxq %[zero], %[" t4 "]\n\t" \
+  "adoxq %[zero], %[" t5 "]\n\t" \
+  "adcxq %[zero], %[" t5 "]\n\t"
+
+// Same result as mont_mul_limbs, on the MULX/ADX kernels (see
+// uint256_limb.h). Free of data-dependent branches like the
+// portable loop, so it also serves the constant-time ladder.
+static inline void mont_mul_adx( uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const uint64_t m[4], uint64_t m0inv ) {
+  uint64_t t0 = 0, t1 = 0, t2 = 0, t3 = 0, t4 = 0, t5 = 0, lo, hi, zero;
+  __asm__(
+    MONT_ADX_ROW("0", "t0", "t1", "t2", "t3", "t4", "t5")
+    MONT_ADX_ROW("8", "t1", "t2", "t3", "t4", "t5", "t0")
+    MONT_ADX_ROW("16", "t2", "t3", "t4", "t5", "t0", "t1")
+    MONT_ADX_ROW("24", "t3", "t4", "t5", "t0", "t1", "t2")
+    : [t0] "+r"(t0), [t1] "+r"(t1), [t2] "+r"(t2), [t3] "+r"(t3), [t4] "+r"(t4), [t5] "+r"(t5),
+      [lo] "=&r"(lo), [hi] "=&r"(hi), [zero] "=&r"(zero)
+    : [a] "r"(a), [b] "r"(b), [m] "r"(m), [m0inv] "rm"(m0inv)
+    : "rdx", "cc", "memory");
+  uint64_t t[4] = {t4, t5, t0, t1};
+  mod_cond_sub(r, t, t2, m);
+}
+#endif
+
+// mont_mul_limbs through the ADX kernel when the CPU has it.
+static inline void mont_mul_dispatch( uint64_t r[4], const uint64_t a[4], const uint64_t b[4], const uint64_t m[4], uint64_t m0inv ) {
+#ifdef UINT256_X86_INTRIN
+  if (limbs_have_adx) {
+    mont_mul_adx(r, a, b, m, m0inv);
+    return;
+  }
+#endif
+  mont_mul_limbs(r, a, b, m, m0inv);
+}
+
+// Montgomery reduction t*R^-1 mod m of an 8-limb value t < m*R.
+// Overwrites t.
+static inline void mont_redc_limbs( uint64_t r[4], uint64_t t[8], const uint64_t m[4], uint64_t m0inv ) {
+  unsigned char top = 0;
+#pragma GCC unroll 4
+  for (int i = 0; i < 4; i++) {
+    uint64_t mq = t[i] * m0inv;
+    uint64_t c = 0;
+    for (int j = 0; j < 4; j++) {
+      t[i + j] = limb_mac(mq, m[j], t[i + j], c, &c);
+    }
+    //the carry out of this row's top limb lands in the next row's
+    t[i + 4] = limb_addc(t[i + 4], c, top, &top);
+  }
+  mod_cond_sub(r, &t[4], top, m);
+}
+
+// Set up a Montgomery context for the given modulus.
+// Returns 1 on success, or 0 if the modulus is even or equal to 1.
+int uint256_mont_ctx_init( UInt256MontCtx *ctx, UInt256 mod ) {
+  if (!(mod.data[0] & 1) || uint256_cmp(mod, uint256_create_from_u32(1)) == 0) {
+    return 0;
+  }
+  ctx->mod = mod;
+
+  ctx->m0inv = limb_neg_inv((uint64_t) mod.data[0] | ((uint64_t) mod.data[1] << 32));
+
+  //R mod m == (R - m) mod m, and R^2 mod m follows from it
+  ctx->one = uint256_mod(uint256_negate(mod), mod);
+  ctx->r2 = uint512_mod(uint256_mul_wide(ctx->one, ctx->one), mod);
+  return 1;
+}
+
+// Convert a value into Montgomery form. Any UInt256 value is
+// accepted; the result is reduced modulo m.
+UInt256 uint256_to_mont( const UInt256MontCtx *ctx, UInt256 val ) {
+  //val * R^2 < R * m, which is all the CIOS loop needs
+  return uint256_mont_mul(ctx, val, ctx->r2);
+}
+
+// Convert a value out of Montgomery form.
+UInt256 uint256_from_mont( const UInt256MontCtx *ctx, UInt256 val ) {
+  uint64_t t[8] = {0, 0, 0, 0, 0, 0, 0, 0}, m[4], r[4];
+  UInt256 result;
+  limbs_load(t, &val);
+  limbs_load(m, &ctx->mod);
+  mont_redc_limbs(r, t, m, ctx->m0inv);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Montgomery product of two values in Montgomery form (both must be
+// less than the modulus). The result is in Montgomery form.
+UInt256 uint256_mont_mul( const UInt256MontCtx *ctx, UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], m[4], r[4];
+  UInt256 result;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  limbs_load(m, &ctx->mod);
+  mont_mul_dispatch(r, a, b, m, ctx->m0inv);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Montgomery square of a value in Montgomery form.
+UInt256 uint256_mont_sqr( const UInt256MontCtx *ctx, UInt256 val ) {
+  uint64_t a[4], t[8], m[4], r[4];
+  UInt256 result;
+  limbs_load(a, &val);
+  limbs_load(m, &ctx->mod);
+  //the square kernel saves the repeated cross products, then a
+  //separate reduction pass brings it back to four limbs
+  limbs_sqr_wide(t, a);
+  mont_redc_limbs(r, t, m, ctx->m0inv);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Modular sum of two values less than the modulus. Works the same
+// on Montgomery-form and ordinary residues.
+UInt256 uint256_mont_add( const UInt256MontCtx *ctx, UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], m[4], s[4], r[4];
+  unsigned char carry = 0;
+  UInt256 result;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  limbs_load(m, &ctx->mod);
+  for (int i = 0; i < 4; i++) {
+    s[i] = limb_addc(a[i], b[i], carry, &carry);
+  }
+  mod_cond_sub(r, s, carry, m);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Modular difference of two values less than the modulus.
+UInt256 uint256_mont_sub( const UInt256MontCtx *ctx, UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], m[4], d[4];
+  UInt256 result;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  limbs_load(m, &ctx->mod);
+  mod_sub_limbs(d, a, b, m);
+  limbs_store(&result, d);
+  return result;
+}
+
+// Subtract the 4-limb m from the 5-limb t if t >= m, without
+// branching.
+static inline void barrett_cond_sub( uint64_t t[5], const uint64_t m[4] ) {
+  uint64_t d[5];
+  unsigned char borrow = 0;
+  for (int i = 0; i < 4; i++) {
+    d[i] = limb_subb(t[i], m[i], borrow, &borrow);
+  }
+  d[4] = limb_subb(t[4], 0, borrow, &borrow);
+  uint64_t keep = (uint64_t) 0 - borrow;
+  for (int i = 0; i < 5; i++) {
+    t[i] = (t[i] & keep) | (d[i] & ~keep);
+  }
+}
+
+// Barrett reduction (HAC 14.42, base 2^64, k = 4) of an 8-limb x
+// modulo the normalized 4-limb modulus n (top bit set), with
+// mu = floor(2^512 / n). The quotient estimate
+// q = ((x >> 192) * mu) >> 320 is computed in Comba column order,
+// skipping the three lowest columns of the product (HAC 14.44):
+// their only effect is a carry that can make q one smaller still.
+// q is then at most 3 short, so x - q*n computed mod 2^320 needs
+// at most three corrections. All shifts are whole limbs.
+static inline void barrett_reduce_limbs( uint64_t r[4], const uint64_t x[8], const uint64_t n[4], const uint64_t mu[5] ) {
+  const uint64_t *q1 = &x[3];
+  uint64_t q3[5], prod[5], t[5];
+  Column col = {0, 0, 0};
+
+  //q3 = (q1 * mu) >> 320, columns 3 and 4 only feed carries
+#pragma GCC unroll 6
+  for (int k = 3; k < 9; k++) {
+    int lo = k < 5 ? 0 : k - 4;
+#pragma GCC unroll 5
+    for (int i = lo; i <= (k < 5 ? k : 4); i++) {
+      col_mac(&col, q1[i], mu[k - i]);
+    }
+    uint64_t w = col_next(&col);
+    if (k >= 5) {
+      q3[k - 5] = w;
+    }
+  }
+  q3[4] = col.c0;
+
+  //prod = q3 * n mod 2^320, the top column only needs its low word
+  col.c0 = col.c1 = col.c2 = 0;
+#pragma GCC unroll 4
+  for (int k = 0; k < 4; k++) {
+#pragma GCC unroll 4
+    for (int i = 0; i <= k; i++) {
+      col_mac(&col, q3[i], n[k - i]);
+    }
+    prod[k] = col_next(&col);
+  }
+  prod[4] = col.c0 + q3[1] * n[3] + q3[2] * n[2] + q3[3] * n[1] + q3[4] * n[0];
+
+  unsigned char borrow = 0;
+  for (int i = 0; i < 5; i++) {
+    t[i] = limb_subb(x[i], prod[i], borrow, &borrow);
+  }
+  barrett_cond_sub(t, n);
+  barrett_cond_sub(t, n);
+  barrett_cond_sub(t, n);
+  for (int i = 0; i < 4; i++) {
+    r[i] = t[i];
+  }
+}
+
+// Set up a Barrett context for the given modulus.
+// Returns 1 on success, or 0 if the modulus is zero.
+int uint256_barrett_ctx_init( UInt256BarrettCtx *ctx, UInt256 mod ) {
+  uint64_t m[4], num[DIV_MAX_LIMBS], q[DIV_MAX_LIMBS], r[4];
+  limbs_load(m, &mod);
+  int used = limbs_used(m, 4);
+  if (used == 0) {
+    return 0;
+  }
+  ctx->mod = mod;
+
+  //work with m shifted up so its top bit is bit 255; then
+  //(x << shift) mod (m << shift) == (x mod m) << shift
+  ctx->shift = (4 - used) * 64 + limb_clz(m[used - 1]);
+  limbs_shl(ctx->norm, m, 4, ctx->shift);
+
+  //mu = floor(2^512 / norm), between 2^256 and 2^257
+  for (int i = 0; i < DIV_MAX_LIMBS; i++) {
+    num[i] = 0;
+  }
+  num[8] = 1;
+  limbs_divmod(q, r, num, 9, ctx->norm);
+  for (int i = 0; i < 5; i++) {
+    ctx->mu[i] = q[i];
+  }
+  return 1;
+}
+
+// Reduce a 512-bit value modulo the context's modulus. Values whose
+// bit length is at most 512 minus the normalizing shift (which
+// includes any product of two reduced values) take the fast path of
+// two truncated multiplies and three constant-time conditional
+// subtractions; anything longer falls back to a full division.
+UInt256 uint256_barrett_reduce( const UInt256BarrettCtx *ctx, UInt512 val ) {
+  uint64_t x[8], xn[8], r[4];
+  UInt256 result;
+  wide_load(x, &val);
+  //the fast path needs x << shift to fit in 512 bits, which any
+  //product of two reduced values does; anything larger takes the
+  //slow path
+  if (limbs_bit_length(x, 8) > 512 - ctx->shift) {
+    return uint512_mod(val, ctx->mod);
+  }
+  limbs_shl(xn, x, 8, ctx->shift);
+  barrett_reduce_limbs(r, xn, ctx->norm, ctx->mu);
+  limbs_shr(r, r, 4, ctx->shift);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Compute left * right mod m. Both operands should be less than the
+// modulus for the fast path to apply.
+UInt256 uint256_barrett_mul( const UInt256BarrettCtx *ctx, UInt256 left, UInt256 right ) {
+  uint64_t a[4], b[4], x[8], r[4];
+  UInt256 result;
+  limbs_load(a, &left);
+  limbs_load(b, &right);
+  if (limbs_bit_length(a, 4) > 256 - ctx->shift) {
+    return uint256_barrett_reduce(ctx, uint256_mul_wide(left, right));
+  }
+  //normalize one operand instead of the 8-limb product:
+  //(a << shift) * b == (a * b) << shift
+  limbs_shl(a, a, 4, ctx->shift);
+  limbs_mul_wide_dispatch(x, a, b);
+  barrett_reduce_limbs(r, x, ctx->norm, ctx->mu);
+  limbs_shr(r, r, 4, ctx->shift);
+  limbs_store(&result, r);
+  return result;
+}
+
+// Return the w (<= 8) exponent bits starting at bit pos, reading
+// whole 64-bit limbs rather than one bit at a time. Bits past the
+// top of the exponent read as 0.
+static inline unsigned exp_window( const uint64_t e[4], int pos, int w ) {
+  int limb = pos / 64, off = pos % 64;
+  uint64_t bits = e[limb] >> off;
+  if (off + w > 64 && limb < 3) {
+    bits |= e[limb + 1] << (64 - off);
+  }
+  return (unsigned) (bits & ((1u << w) - 1));
+}
+
+// Return the index of the highest set exponent bit at or below pos,
+// or -1 if there is none. Zero limbs are skipped whole, and the bit
+// is found in its limb with a single clz.
+static inline int exp_prev_set( const uint64_t e[4], int pos ) {
+  int limb = pos / 64;
+  //mask off the bits above pos in its limb
+  uint64_t bits = e[limb] & (~(uint64_t) 0 >> (63 - pos % 64));
+  while (bits == 0) {
+    if (--limb < 0) {
+      return -1;
+    }
+    bits = e[limb];
+  }
+  return limb * 64 + 63 - limb_clz(bits);
+}
+
+// Multiplication backend for the sliding-window ladder, so the same
+// code can run on Montgomery residues or on Barrett-reduced ones.
+typedef struct {
+  const void *ctx;
+  UInt256 (*mul)( const void *ctx, UInt256 left, UInt256 right );
+  UInt256 (*sqr)( const void *ctx, UInt256 val );
+} ExpOps;
+
+static UInt256 exp_mont_mul( const void *ctx, UInt256 left, UInt256 right ) {
+  return uint256_mont_mul(ctx, left, right);
+}
+
+static UInt256 exp_mont_sqr( const void *ctx, UInt256 val ) {
+  return uint256_mont_sqr(ctx, val);
+}
+
+static UInt256 exp_barrett_mul( const void *ctx, UInt256 left, UInt256 right ) {
+  return uint256_barrett_mul(ctx, left, right);
+}
+
+static UInt256 exp_barrett_sqr( const void *ctx, UInt256 val ) {
+  return uint256_barrett_reduce(ctx, uint256_mul_wide(val, val));
+}
+
+// Left-to-right sliding-window exponentiation. base and one are
+// already in whatever representation ops works on. Each window is
+// an odd run of at most w bits, so only the odd powers base^1,
+// base^3, ..., base^(2^w - 1) are precomputed.
+static UInt256 sliding_window_exp( const ExpOps *ops, UInt256 one, UInt256 base, UInt256 exp ) {
+  uint64_t e[4];
+  limbs_load(e, &exp);
+  int n = limbs_used(e, 4);
+  if (n == 0) {
+    return one;
+  }
+  int bits = n * 64 - limb_clz(e[n - 1]);
+
+  //window size by exponent length, larger windows only pay off
+  //once there are enough bits to amortize the table
+  int w = bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+  UInt256 table[16];
+  table[0] = base;
+  if (w > 1) {
+    UInt256 base2 = ops->sqr(ops->ctx, base);
+    for (int i = 1; i < (1 << (w - 1)); i++) {
+      table[i] = ops->mul(ops->ctx, table[i - 1], base2);
+    }
+  }
+
+  UInt256 result = one;
+  int started = 0;
+  int i = bits - 1;
+  while (i >= 0) {
+    //skip a run of zero bits in one step: one squaring per bit, but
+    //no per-bit scanning
+    int top = exp_prev_set(e, i);
+    for (int k = top; k < i; k++) {
+      result = ops->sqr(ops->ctx, result);
+    }
+    i = top;
+    if (i < 0) {
+      break;
+    }
+    //longest window ending at bit i whose lowest bit is set: read
+    //the w bits below and including i at once, and drop their
+    //trailing zeros
+    int j = i - w + 1 < 0 ? 0 : i - w + 1;
+    unsigned window = exp_window(e, j, i - j + 1);
+    int tz = limb_ctz(window);
+    j += tz;
+    int len = i - j + 1;
+    unsigned idx = (window >> tz) >> 1;
+    if (started) {
+      for (int k = 0; k < len; k++) {
+        result = ops->sqr(ops->ctx, result);
+      }
+      result = ops->mul(ops->ctx, result, table[idx]);
+    } else {
+      //the leading window needs no squarings of 1
+      result = table[idx];
+      started = 1;
+    }
+    i = j - 1;
+  }
+  return result;
+}
+
+// Compute base^exp mod m with a precomputed Montgomery context.
+// base and the result are ordinary (not Montgomery-form) values.
+UInt256 uint256_mont_exp( const UInt256MontCtx *ctx, UInt256 base, UInt256 exp ) {
+  ExpOps ops = { ctx, exp_mont_mul, exp_mont_sqr };
+  UInt256 result = sliding_window_exp(&ops, ctx->one, uint256_to_mont(ctx, base), exp);
+  return uint256_from_mont(ctx, result);
+}
+
+// Compute base^exp mod mod. mod must be nonzero.
+UInt256 uint256_modexp( UInt256 base, UInt256 exp, UInt256 mod ) {
+  UInt256MontCtx ctx;
+  if (uint256_mont_ctx_init(&ctx, mod)) {
+    return uint256_mont_exp(&ctx, base, exp);
+  }
+  UInt256 one = uint256_create_from_u32(1);
+  if (uint256_cmp(mod, one) == 0) {
+    return uint256_create_from_u32(0);
+  }
+  //even modulus: no Montgomery form, use Barrett reduction instead
+  UInt256BarrettCtx barrett;
+  uint256_barrett_ctx_init(&barrett, mod);
+  ExpOps ops = { &barrett, exp_barrett_mul, exp_barrett_sqr };
+  return sliding_window_exp(&ops, one, uint256_mod(base, mod), exp);
+}
+
+// Constant-time fixed-window exponentiation. Every one of the 64
+// four-bit windows costs four squarings and one multiply, and the
+// table entry is picked by reading all 16 entries under a mask, so
+// neither the operation sequence nor the memory access pattern
+// depends on base or exp.
+UInt256 uint256_mont_exp_ct( const UInt256MontCtx *ctx, UInt256 base, UInt256 exp ) {
+  uint64_t m[4], e[4], table[16][4], r[4], t[8];
+  UInt256 result;
+  limbs_load(m, &ctx->mod);
+  limbs_load(e, &exp);
+
+  UInt256 base_m = uint256_to_mont(ctx, base);
+  limbs_load(table[0], &ctx->one);
+  limbs_load(table[1], &base_m);
+  for (int i = 2; i < 16; i++) {
+    mont_mul_dispatch(table[i], table[i - 1], table[1], m, ctx->m0inv);
+  }
+
+  for (int k = 0; k < 4; k++) {
+    r[k] = table[0][k];
+  }
+  for (int pos = 252; pos >= 0; pos -= 4) {
+    for (int s = 0; s < 4; s++) {
+      limbs_sqr_wide(t, r);
+      mont_redc_limbs(r, t, m, ctx->m0inv);
+    }
+    uint64_t idx = exp_window(e, pos, 4);
+    uint64_t sel[4] = {0, 0, 0, 0};
+    for (uint64_t i = 0; i < 16; i++) {
+      //all ones when i == idx, computed without a compare-and-branch
+      uint64_t mask = (uint64_t) 0 - (((i ^ idx) - 1) >> 63);
+      for (int k = 0; k < 4; k++) {
+        sel[k] |= table[i][k] & mask;
+      }
+    }
+    mont_mul_dispatch(r, r, sel, m, ctx->m0inv);
+  }
+
+  limbs_store(&result, r);
+  return uint256_from_mont(ctx, result);
+}
+
+// Constant-time version of uint256_modexp. mod must be odd and
+// greater than 1.
+UInt256 uint256_modexp_ct( UInt256 base, UInt256 exp, UInt256 mod ) {
+  UInt256MontCtx ctx;
+  int ok = uint256_mont_ctx_init(&ctx, mod);
+  assert(ok);
+  (void) ok;
+  return uint256_mont_exp_ct(&ctx, base, exp);
+}
+
+// r = (u*f + v*g) / 2^GCD_STEPS mod m, for u, v < m, odd m and the
+// signed factors of a GcdMatrix row. A negative factor multiplies
+// m - u (or m - v) instead, making every term non-negative. Adding
+// the multiple of m that clears the low bits (m0inv is -m^-1 mod
+// 2^64, as in the Montgomery context) makes the sum divisible by
+// 2^GCD_STEPS, and the quotient is below 3m.
+static inline void gcd_coeff( uint64_t r[4], const uint64_t u[4], int64_t f, const uint64_t v[4], int64_t g,
+                              const uint64_t m[4], uint64_t m0inv ) {
+  uint64_t zero[4] = {0, 0, 0, 0}, nu[4], nv[4], t[6], c1 = 0, c2 = 0;
+  mod_sub_limbs(nu, zero, u, m);
+  mod_sub_limbs(nv, zero, v, m);
+  const uint64_t *uu = f < 0 ? nu : u, *vv = g < 0 ? nv : v;
+  uint64_t fa = f < 0 ? (uint64_t) 0 - (uint64_t) f : (uint64_t) f;
+  uint64_t ga = g < 0 ? (uint64_t) 0 - (uint64_t) g : (uint64_t) g;
+  for (int i = 0; i < 4; i++) {
+    t[i] = limb_mac(uu[i], fa, 0, c1, &c1);
+    t[i] = limb_mac(vv[i], ga, t[i], c2, &c2);
+  }
+  t[4] = c1 + c2;
+
+  uint64_t k = (t[0] * m0inv) & (((uint64_t) 1 << GCD_STEPS) - 1), c = 0;
+  unsigned char carry = 0;
+  for (int i = 0; i < 4; i++) {
+    t[i] = limb_mac(k, m[i], t[i], c, &c);
+  }
+  t[4] = limb_addc(t[4], c, 0, &carry);
+  limbs_shr(t, t, 5, GCD_STEPS);
+
+  //below 3m: take m off twice, each time only if that doesn't go
+  //negative
+  for (int pass = 0; pass < 2; pass++) {
+    uint64_t d[5];
+    unsigned char borrow = 0;
+    for (int i = 0; i < 4; i++) {
+      d[i] = limb_subb(t[i], m[i], borrow, &borrow);
+    }
+    d[4] = limb_subb(t[4], 0, borrow, &borrow);
+    uint64_t keep = (uint64_t) 0 - borrow;
+    for (int i = 0; i < 5; i++) {
+      t[i] = (t[i] & keep) | (d[i] & ~keep);
+    }
+  }
+  memcpy(r, t, 4 * sizeof(uint64_t));
+}
+
+static inline int limbs_is_one( const uint64_t w[4] ) {
+  return ((w[0] ^ 1) | w[1] | w[2] | w[3]) == 0;
+}
+
+// Inverse of a (reduced, a < m) modulo an odd m by the batched
+// binary GCD of uint256_gcd, extended with the coefficients u and v
+// that keep a == u*x and b == v*x (mod m) for the original x. When
+// a reaches 0, b is gcd(x, m), and if that is 1, v is the inverse.
+static int modinv_odd( uint64_t inv[4], const uint64_t x[4], const uint64_t m[4] ) {
+  uint64_t a[4], b[4], u[4] = {1, 0, 0, 0}, v[4] = {0, 0, 0, 0}, na[4], nu[4];
+  uint64_t m0inv = limb_neg_inv(m[0]);
+  memcpy(a, x, sizeof(a));
+  memcpy(b, m, sizeof(b));
+  while (a[0] | a[1] | a[2] | a[3]) {
+    GcdMatrix mat = gcd_steps(a, b);
+    if (gcd_apply(na, a, mat.f0, b, mat.g0)) {
+      mat.f0 = -mat.f0;
+      mat.g0 = -mat.g0;
+    }
+    if (gcd_apply(b, a, mat.f1, b, mat.g1)) {
+      mat.f1 = -mat.f1;
+      mat.g1 = -mat.g1;
+    }
+    memcpy(a, na, sizeof(a));
+    gcd_coeff(nu, u, mat.f0, v, mat.g0, m, m0inv);
+    gcd_coeff(v, u, mat.f1, v, mat.g1, m, m0inv);
+    memcpy(u, nu, sizeof(u));
+  }
+  memcpy(inv, v, sizeof(v));
+  return limbs_is_one(b);
+}
+
+// Inverse of a (a < m) by the extended Euclidean algorithm, for even
+// moduli. The Bezout coefficients alternate in sign and never exceed
+// m in size, so only their magnitudes are kept: t_{k+1} = t_{k-1} +
+// q_k * t_k, with the sign restored from the step count at the end.
+static int modinv_euclid( uint64_t inv[4], const uint64_t a[4], const uint64_t m[4] ) {
+  uint64_t r0[4], r1[4], t0[4] = {0, 0, 0, 0}, t1[4] = {1, 0, 0, 0};
+  uint64_t q[4], rem[4], p[4];
+  int steps = 0;
+  memcpy(r0, m, sizeof(r0));
+  memcpy(r1, a, sizeof(r1));
+  while (r1[0] | r1[1] | r1[2] | r1[3]) {
+    unsigned char carry = 0;
+    limbs_divmod(q, rem, r0, 4, r1);
+    limbs_mul_lo_dispatch(p, q, t1);
+    for (int i = 0; i < 4; i++) {
+      p[i] = limb_addc(p[i], t0[i], carry, &carry);
+    }
+    memcpy(t0, t1, sizeof(t0));
+    memcpy(t1, p, sizeof(t1));
+    memcpy(r0, r1, sizeof(r0));
+    memcpy(r1, rem, sizeof(r1));
+    steps++;
+  }
+  if (!limbs_is_one(r0)) {
+    return 0;
+  }
+  //t0 is positive after an odd number of steps, negative after an
+  //even number
+  if (steps % 2 == 0) {
+    uint64_t zero[4] = {0, 0, 0, 0};
+    mod_sub_limbs(inv, zero, t0, m);
+  } else {
+    memcpy(inv, t0, sizeof(t0));
+  }
+  return 1;
+}
+
+// Compute the inverse of val modulo mod. Returns 1 and stores the
+// inverse through result if it exists, or 0 if it doesn't.
+int uint256_modinv( UInt256 val, UInt256 mod, UInt256 *result ) {
+  uint64_t v[4], m[4], q[4], a[4], inv[4];
+  limbs_load(m, &mod);
+  if (limbs_bit_length(m, 4) < 2) {
+    return 0;
+  }
+  limbs_load(v, &val);
+  limbs_divmod(q, a, v, 4, m);
+  int ok = (m[0] & 1) ? modinv_odd(inv, a, m) : modinv_euclid(inv, a, m);
+  if (ok) {
+    limbs_store(result, inv);
+  }
+  return ok;
+}
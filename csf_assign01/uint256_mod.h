@@ -0,0 +1,102 @@
+#ifndef UINT256_MOD_H
+#define UINT256_MOD_H
+
+#include "uint256.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Precomputed state for Montgomery arithmetic modulo a fixed odd
+// modulus m. A value x is held in Montgomery form as x*R mod m,
+// where R = 2^256. The context is read-only after
+// uint256_mont_ctx_init, so one context can be shared by any number
+// of callers.
+typedef struct {
+  UInt256 mod;     // the modulus m (odd, greater than 1)
+  UInt256 r2;      // R^2 mod m, used to convert into Montgomery form
+  UInt256 one;     // R mod m, i.e. the value 1 in Montgomery form
+  uint64_t m0inv;  // -m^-1 mod 2^64
+} UInt256MontCtx;
+
+// Set up a Montgomery context for the given modulus.
+// Returns 1 on success, or 0 if the modulus is even or equal to 1.
+int uint256_mont_ctx_init( UInt256MontCtx *ctx, UInt256 mod );
+
+// Convert a value into Montgomery form. Any UInt256 value is
+// accepted; the result is reduced modulo m.
+UInt256 uint256_to_mont( const UInt256MontCtx *ctx, UInt256 val );
+
+// Convert a value out of Montgomery form.
+UInt256 uint256_from_mont( const UInt256MontCtx *ctx, UInt256 val );
+
+// Montgomery product of two values in Montgomery form (both must be
+// less than the modulus). The result is in Montgomery form.
+UInt256 uint256_mont_mul( const UInt256MontCtx *ctx, UInt256 left, UInt256 right );
+
+// Montgomery square of a value in Montgomery form.
+UInt256 uint256_mont_sqr( const UInt256MontCtx *ctx, UInt256 val );
+
+// Modular sum of two values less than the modulus. Works the same
+// on Montgomery-form and ordinary residues.
+UInt256 uint256_mont_add( const UInt256MontCtx *ctx, UInt256 left, UInt256 right );
+
+// Modular difference of two values less than the modulus.
+UInt256 uint256_mont_sub( const UInt256MontCtx *ctx, UInt256 left, UInt256 right );
+
+// Precomputed state for Barrett reduction modulo a fixed modulus m,
+// which (unlike Montgomery) may be even. Read-only after
+// uint256_barrett_ctx_init.
+typedef struct {
+  UInt256 mod;       // the modulus m (nonzero)
+  uint64_t norm[4];  // m shifted left until its top bit is set
+  uint64_t mu[5];    // floor(2^512 / norm), as 64-bit limbs
+  int shift;         // how far m was shifted to get norm
+} UInt256BarrettCtx;
+
+// Set up a Barrett context for the given modulus.
+// Returns 1 on success, or 0 if the modulus is zero.
+int uint256_barrett_ctx_init( UInt256BarrettCtx *ctx, UInt256 mod );
+
+// Reduce a 512-bit value modulo the context's modulus. Values whose
+// bit length is at most 512 minus the normalizing shift (which
+// includes any product of two reduced values) take the fast path of
+// two truncated multiplies and three constant-time conditional
+// subtractions; anything longer falls back to a full division.
+UInt256 uint256_barrett_reduce( const UInt256BarrettCtx *ctx, UInt512 val );
+
+// Compute left * right mod m. Both operands should be less than the
+// modulus for the fast path to apply.
+UInt256 uint256_barrett_mul( const UInt256BarrettCtx *ctx, UInt256 left, UInt256 right );
+
+// Compute base^exp mod mod, using a sliding window over the exponent.
+// mod must be nonzero. Odd moduli go through Montgomery arithmetic,
+// even ones through Barrett reduction.
+// Not constant-time: running time depends on exp.
+UInt256 uint256_modexp( UInt256 base, UInt256 exp, UInt256 mod );
+
+// Same as uint256_modexp, with a precomputed Montgomery context.
+// base and the result are ordinary (not Montgomery-form) values.
+UInt256 uint256_mont_exp( const UInt256MontCtx *ctx, UInt256 base, UInt256 exp );
+
+// Constant-time base^exp mod mod: the sequence of operations and
+// memory accesses does not depend on base or exp. mod must be odd
+// and greater than 1.
+UInt256 uint256_modexp_ct( UInt256 base, UInt256 exp, UInt256 mod );
+
+// Constant-time version of uint256_mont_exp.
+UInt256 uint256_mont_exp_ct( const UInt256MontCtx *ctx, UInt256 base, UInt256 exp );
+
+// Compute the inverse of val modulo mod, the x < mod with
+// val*x == 1 (mod mod). Returns 1 and stores x through result if it
+// exists; returns 0 and leaves *result unchanged if it doesn't
+// (gcd( val, mod ) != 1, or mod < 2). val need not be reduced. Works
+// for any modulus: odd moduli use the extended binary GCD, even ones
+// the extended Euclidean algorithm. Not constant-time.
+int uint256_modinv( UInt256 val, UInt256 mod, UInt256 *result );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UINT256_MOD_H
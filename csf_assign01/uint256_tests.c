@@ -1,8 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "tctest.h"
 
 #include "uint256.h"
+#include "uint256_mod.h"
+#include "uint256_inline.h"
+#include "uint256_batch.h"
+#include "uint256_io.h"
 
 typedef struct {
   UInt256 zero; // the value equal to 0
@@ -13,6 +19,9 @@ typedef struct {
 
 // Helper functions for implementing tests
 void set_all( UInt256 *val, uint32_t wordval );
+uint64_t test_rand( void );
+UInt256 random_operand( void );
+UInt256 from_u64( uint64_t word );
 
 #define ASSERT_SAME( expected, actual ) \
 do { \
@@ -54,6 +63,56 @@ void test_add_edgecases();
 void test_subtract_edgecases();
 void test_multiply_edgecases();
 void test_lshift_edgecases();
+void test_add_sub_carry_chain( TestObjs *objs );
+void test_mul_full_width( TestObjs *objs );
+void test_sqr( TestObjs *objs );
+void test_mul_wide( TestObjs *objs );
+void test_mul_overflows( TestObjs *objs );
+void test_divmod( TestObjs *objs );
+void test_divmod_edgecases( TestObjs *objs );
+void test_divmod_random( TestObjs *objs );
+void test_divmod_u64( TestObjs *objs );
+void test_mont_ctx_init( TestObjs *objs );
+void test_mont_mul( TestObjs *objs );
+void test_mont_random( TestObjs *objs );
+void test_modexp( TestObjs *objs );
+void test_modexp_random( TestObjs *objs );
+void test_barrett( TestObjs *objs );
+void test_barrett_random( TestObjs *objs );
+void test_format_hex_into( TestObjs *objs );
+void test_format_hex_into_random( TestObjs *objs );
+void test_dec_roundtrip( TestObjs *objs );
+void test_dec_edgecases( TestObjs *objs );
+void test_dec_random( TestObjs *objs );
+void test_parse_hex( TestObjs *objs );
+void test_parse_hex_random( TestObjs *objs );
+void test_rshift( TestObjs *objs );
+void test_rotate( TestObjs *objs );
+void test_bitwise( TestObjs *objs );
+void test_shift_random( TestObjs *objs );
+void test_inplace_ops( TestObjs *objs );
+void test_inplace_aliasing( TestObjs *objs );
+void test_inline_ops( TestObjs *objs );
+void test_batch_carries( TestObjs *objs );
+void test_batch_random( TestObjs *objs );
+void test_acc_carries( TestObjs *objs );
+void test_acc_random( TestObjs *objs );
+void test_bit_scan( TestObjs *objs );
+void test_bit_scan_random( TestObjs *objs );
+void test_gcd( TestObjs *objs );
+void test_gcd_random( TestObjs *objs );
+void test_isqrt( TestObjs *objs );
+void test_isqrt_random( TestObjs *objs );
+void test_modinv( TestObjs *objs );
+void test_modinv_random( TestObjs *objs );
+void test_adx_kernels( TestObjs *objs );
+void test_checked_arith( TestObjs *objs );
+void test_checked_random( TestObjs *objs );
+void test_u64_ops( TestObjs *objs );
+void test_u64_random( TestObjs *objs );
+void test_bytes_encode( TestObjs *objs );
+void test_bytes_random( TestObjs *objs );
+void test_array_file( TestObjs *objs );
 
 int main( int argc, char **argv ) {
   if ( argc > 1 )
@@ -78,6 +137,56 @@ int main( int argc, char **argv ) {
   TEST(test_subtract_edgecases);
   TEST(test_multiply_edgecases);
   TEST(test_lshift_edgecases);
+  TEST( test_add_sub_carry_chain );
+  TEST( test_mul_full_width );
+  TEST( test_sqr );
+  TEST( test_mul_wide );
+  TEST( test_mul_overflows );
+  TEST( test_divmod );
+  TEST( test_divmod_edgecases );
+  TEST( test_divmod_random );
+  TEST( test_divmod_u64 );
+  TEST( test_mont_ctx_init );
+  TEST( test_mont_mul );
+  TEST( test_mont_random );
+  TEST( test_modexp );
+  TEST( test_modexp_random );
+  TEST( test_barrett );
+  TEST( test_barrett_random );
+  TEST( test_format_hex_into );
+  TEST( test_format_hex_into_random );
+  TEST( test_dec_roundtrip );
+  TEST( test_dec_edgecases );
+  TEST( test_dec_random );
+  TEST( test_parse_hex );
+  TEST( test_parse_hex_random );
+  TEST( test_rshift );
+  TEST( test_rotate );
+  TEST( test_bitwise );
+  TEST( test_shift_random );
+  TEST( test_inplace_ops );
+  TEST( test_inplace_aliasing );
+  TEST( test_inline_ops );
+  TEST( test_batch_carries );
+  TEST( test_batch_random );
+  TEST( test_acc_carries );
+  TEST( test_acc_random );
+  TEST( test_bit_scan );
+  TEST( test_bit_scan_random );
+  TEST( test_gcd );
+  TEST( test_gcd_random );
+  TEST( test_isqrt );
+  TEST( test_isqrt_random );
+  TEST( test_modinv );
+  TEST( test_modinv_random );
+  TEST( test_adx_kernels );
+  TEST( test_checked_arith );
+  TEST( test_checked_random );
+  TEST( test_u64_ops );
+  TEST( test_u64_random );
+  TEST( test_bytes_encode );
+  TEST( test_bytes_random );
+  TEST( test_array_file );
   
   TEST_FINI();
 }
@@ -89,6 +198,40 @@ void set_all( UInt256 *val, uint32_t wordval ) {
   }
 }
 
+// Deterministic xorshift64 generator for the randomized tests
+static uint64_t test_rand_state = 0x2545f4914f6cdd1dULL;
+uint64_t test_rand( void ) {
+  test_rand_state ^= test_rand_state << 13;
+  test_rand_state ^= test_rand_state >> 7;
+  test_rand_state ^= test_rand_state << 17;
+  return test_rand_state;
+}
+
+// Random value with a random number of significant bits, so that
+// operands of every limb length show up
+UInt256 random_operand( void ) {
+  UInt256 val;
+  for ( unsigned i = 0; i < 8; i += 2 ) {
+    uint64_t r = test_rand();
+    val.data[i] = (uint32_t) r;
+    val.data[i + 1] = (uint32_t) (r >> 32);
+  }
+  unsigned bits = 1 + test_rand() % 256;
+  for ( unsigned i = 0; i < 8; ++i ) {
+    if ( bits <= i * 32 )
+      val.data[i] = 0;
+    else if ( bits < (i + 1) * 32 )
+      val.data[i] &= (1U << (bits - i * 32)) - 1;
+  }
+  return val;
+}
+
+UInt256 from_u64( uint64_t word ) {
+  UInt256 val = uint256_create_from_u32( (uint32_t) word );
+  val.data[1] = (uint32_t) (word >> 32);
+  return val;
+}
+
 TestObjs *setup( void ) {
   TestObjs *objs = (TestObjs *) malloc( sizeof(TestObjs ) );
 
@@ -630,3 +773,1479 @@ void test_lshift_edgecases() {
   ASSERT_SAME(expected64, result);
 }
 
+
+void test_add_sub_carry_chain( TestObjs *objs ) {
+  UInt256 result;
+
+  // carry out of the low 32-bit half into the high half of a 64-bit limb
+  UInt256 low_word = {{0xFFFFFFFFU, 0, 0, 0, 0, 0, 0, 0}};
+  UInt256 expected_low = {{0, 1U, 0, 0, 0, 0, 0, 0}};
+  result = uint256_add( low_word, objs->one );
+  ASSERT_SAME( expected_low, result );
+  result = uint256_sub( expected_low, objs->one );
+  ASSERT_SAME( low_word, result );
+
+  // carry out of one 64-bit limb into the next
+  UInt256 low_limb = {{0xFFFFFFFFU, 0xFFFFFFFFU, 0, 0, 0, 0, 0, 0}};
+  UInt256 expected_limb = {{0, 0, 1U, 0, 0, 0, 0, 0}};
+  result = uint256_add( low_limb, objs->one );
+  ASSERT_SAME( expected_limb, result );
+  result = uint256_sub( expected_limb, objs->one );
+  ASSERT_SAME( low_limb, result );
+
+  // carry rippling all the way through limbs 1..3 only
+  UInt256 upper = {{0, 0, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU, 0xFFFFFFFFU}};
+  UInt256 bit64 = {{0, 0, 1U, 0, 0, 0, 0, 0}};
+  result = uint256_add( upper, bit64 );
+  ASSERT_SAME( objs->zero, result );
+
+  // borrow from the msb
+  UInt256 expected_neg = {{0, 0, 0, 0, 0, 0, 0, 0x80000000U}};
+  result = uint256_negate( objs->msb_set );
+  ASSERT_SAME( expected_neg, result );
+  result = uint256_sub( objs->zero, objs->msb_set );
+  ASSERT_SAME( objs->msb_set, result );
+
+  // a - b == a + -b, and (a + b) - b == a
+  UInt256 a = uint256_create_from_hex( "8e91ef1c3b04397515d0e6a92512b58d94163b9d5ac5b027d2ab7b0fcf3c42e" );
+  UInt256 b = uint256_create_from_hex( "fcb121d798221417eb4b59a27681fd05cf389a641230efc73731f99a2ade38f" );
+  UInt256 diff = uint256_sub( a, b );
+  result = uint256_add( a, uint256_negate( b ) );
+  ASSERT_SAME( diff, result );
+  result = uint256_sub( uint256_add( a, b ), b );
+  ASSERT_SAME( a, result );
+  result = uint256_negate( uint256_negate( a ) );
+  ASSERT_SAME( a, result );
+}
+
+void test_mul_full_width( TestObjs *objs ) {
+  char *s;
+  UInt256 result;
+  (void) objs;
+
+  // full 256-bit operands, product truncated to the low 256 bits
+  UInt256 value1 = uint256_create_from_hex( "d23f0824128b2f330c5c7fd0a6a3a4506513270e269e0d37f2a74de452e6b438" );
+  UInt256 value2 = uint256_create_from_hex( "36f675cc81e74ef5e8e25d940ed904759531985d5d9dc9f81818e811892f902b" );
+  result = uint256_mul( value1, value2 );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "65f99d1ee00db3dc2ae0851bd5090f341bd44e608453d25b1517ea80c067c568", s ) );
+  free( s );
+
+  value1 = uint256_create_from_hex( "8d116ece1738f7d93d9c172411e20b8f6b0d549b6f03675a1600a35a099950d8" );
+  value2 = uint256_create_from_hex( "a170b33839263059f28c105d1fb17c2390c192cfd3ac94af0f21ddb66cad4a26" );
+  result = uint256_mul( value1, value2 );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "c7ecb566d0c16b61a3aaeb1811319d01fa0d282761d9bd8814d7626a80187010", s ) );
+  free( s );
+
+  value1 = uint256_create_from_hex( "cb1e29c658cda1495e60af593bd04cf0fd630f1f29d0da9953f48f1a09f76b5" );
+  value2 = uint256_create_from_hex( "6b4cb2424a23d5962217beaddbc496cb8e81973e0becd7b03898d190f9ebdacc" );
+  result = uint256_mul( value1, value2 );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "2f74db17e1de53fa0f0e9b92a25a6284bc8b9d96e89007686aa9fafbcf4fba3c", s ) );
+  free( s );
+
+  // multiplication commutes
+  result = uint256_mul( value2, value1 );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "2f74db17e1de53fa0f0e9b92a25a6284bc8b9d96e89007686aa9fafbcf4fba3c", s ) );
+  free( s );
+}
+
+void test_sqr( TestObjs *objs ) {
+  char *s;
+  UInt256 result;
+
+  result = uint256_sqr( objs->zero );
+  ASSERT_SAME( objs->zero, result );
+
+  result = uint256_sqr( objs->one );
+  ASSERT_SAME( objs->one, result );
+
+  // (2^256 - 1)^2 == 1 (mod 2^256)
+  result = uint256_sqr( objs->max );
+  ASSERT_SAME( objs->one, result );
+
+  // (2^255)^2 == 0 (mod 2^256)
+  result = uint256_sqr( objs->msb_set );
+  ASSERT_SAME( objs->zero, result );
+
+  // doubled cross terms carrying into the next column
+  UInt256 half = uint256_create_from_hex( "ffffffffffffffffffffffffffffffff" );
+  result = uint256_sqr( half );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "fffffffffffffffffffffffffffffffe00000000000000000000000000000001", s ) );
+  free( s );
+
+  UInt256 value = uint256_create_from_hex( "ae97ba94d0eda82f8f6d05584ef8aa38922766581e27a1c08a6a63ec24ede6a4" );
+  result = uint256_sqr( value );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "570562d8fad7504ae3c04fb2784d0dd5d4080be6d54bce0fec27dc52fb731910", s ) );
+  free( s );
+  ASSERT_SAME( uint256_mul( value, value ), result );
+
+  value = uint256_create_from_hex( "18f135d25f557203301850c5a38fd547923a736994e3bf911a61dbe22e44158b" );
+  result = uint256_sqr( value );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "4be6b6124d655ddd7b77f9de492d3d07d27bf1013d71786cc4c4654567a81979", s ) );
+  free( s );
+}
+
+void test_mul_wide( TestObjs *objs ) {
+  char *s;
+  UInt512 wide;
+
+  wide = uint256_mul_wide( objs->zero, objs->max );
+  ASSERT_SAME( objs->zero, uint512_lo( wide ) );
+  ASSERT_SAME( objs->zero, uint512_hi( wide ) );
+
+  wide = uint256_mul_wide( objs->one, objs->max );
+  ASSERT_SAME( objs->max, uint512_lo( wide ) );
+  ASSERT_SAME( objs->zero, uint512_hi( wide ) );
+
+  // (2^256 - 1)^2 == (2^256 - 2) * 2^256 + 1
+  wide = uint256_mul_wide( objs->max, objs->max );
+  ASSERT_SAME( objs->one, uint512_lo( wide ) );
+  s = uint256_format_as_hex( uint512_hi( wide ) );
+  ASSERT( 0 == strcmp( "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe", s ) );
+  free( s );
+
+  // 2^255 * 2^255 == 2^510
+  wide = uint256_mul_wide( objs->msb_set, objs->msb_set );
+  ASSERT_SAME( objs->zero, uint512_lo( wide ) );
+  ASSERT( 0x40000000U == wide.data[15] );
+
+  UInt256 value1 = uint256_create_from_hex( "73ab48767734d7c1c7fde805ec99108ddb5b5fab8f4d3e27dda1494c73cf256d" );
+  UInt256 value2 = uint256_create_from_hex( "79cb9e86830c71c2cdcc69292f45e678309d6b79965eda32dae445508201e2bd" );
+  wide = uint256_mul_wide( value1, value2 );
+  s = uint256_format_as_hex( uint512_hi( wide ) );
+  ASSERT( 0 == strcmp( "3707f5b2f1dfd1f955567c2e95b5f170606269c1779dc2d48b6d59170aefa4c1", s ) );
+  free( s );
+  s = uint256_format_as_hex( uint512_lo( wide ) );
+  ASSERT( 0 == strcmp( "e02f83c5a4f4b1b8935e9e0d46d229a910bc575a37d208b24bca538ede65db79", s ) );
+  free( s );
+
+  // the low half is exactly what uint256_mul returns
+  ASSERT_SAME( uint256_mul( value1, value2 ), uint512_lo( wide ) );
+}
+
+void test_mul_overflows( TestObjs *objs ) {
+  ASSERT( !uint256_mul_overflows( objs->zero, objs->max ) );
+  ASSERT( !uint256_mul_overflows( objs->max, objs->one ) );
+  ASSERT( uint256_mul_overflows( objs->max, objs->max ) );
+  ASSERT( uint256_mul_overflows( objs->msb_set, uint256_create_from_u32( 2U ) ) );
+  ASSERT( !uint256_mul_overflows( objs->msb_set, objs->one ) );
+
+  // 3-limb times 2-limb operands: the product may or may not fit
+  UInt256 pow128 = uint256_create_from_hex( "100000000000000000000000000000000" );
+  UInt256 pow127 = uint256_create_from_hex( "80000000000000000000000000000000" );
+  ASSERT( !uint256_mul_overflows( pow128, pow127 ) );
+
+  UInt256 pow128_plus5 = uint256_create_from_hex( "100000000000000000000000000000005" );
+  UInt256 pow128_minus1 = uint256_create_from_hex( "ffffffffffffffffffffffffffffffff" );
+  ASSERT( uint256_mul_overflows( pow128_plus5, pow128_minus1 ) );
+  ASSERT( !uint256_mul_overflows( pow128_minus1, pow128_minus1 ) );
+}
+
+void test_divmod( TestObjs *objs ) {
+  char *s;
+  UInt256 quot, rem;
+  (void) objs;
+
+  // 256-bit by 128-bit division (two-limb divisor)
+  UInt256 num = uint256_create_from_hex( "8e91ef1c3b04397515d0e6a92512b58d94163b9d5ac5b027d2ab7b0fcf3c42e" );
+  UInt256 den = uint256_create_from_hex( "d8d1d910fc0177a85db706b0cca8d0" );
+  quot = uint256_divmod( num, den, &rem );
+  s = uint256_format_as_hex( quot );
+  ASSERT( 0 == strcmp( "a85545a4a68c5c3e73587809255a36fa0", s ) );
+  free( s );
+  s = uint256_format_as_hex( rem );
+  ASSERT( 0 == strcmp( "c8681bac0724009f759fdd3368122e", s ) );
+  free( s );
+  ASSERT_SAME( quot, uint256_div( num, den ) );
+  ASSERT_SAME( rem, uint256_mod( num, den ) );
+
+  // divisor just above 2^192 makes the trial quotient overshoot
+  num = uint256_create_from_hex( "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" );
+  den = uint256_create_from_hex( "1000000000000000000000000000000000000000000000001" );
+  quot = uint256_divmod( num, den, &rem );
+  s = uint256_format_as_hex( quot );
+  ASSERT( 0 == strcmp( "ffffffffffffffff", s ) );
+  free( s );
+  s = uint256_format_as_hex( rem );
+  ASSERT( 0 == strcmp( "ffffffffffffffffffffffffffffffff0000000000000000", s ) );
+  free( s );
+}
+
+void test_divmod_edgecases( TestObjs *objs ) {
+  UInt256 quot, rem;
+
+  // 0 / x == 0 remainder 0
+  quot = uint256_divmod( objs->zero, objs->max, &rem );
+  ASSERT_SAME( objs->zero, quot );
+  ASSERT_SAME( objs->zero, rem );
+
+  // x / 1 == x remainder 0
+  quot = uint256_divmod( objs->max, objs->one, &rem );
+  ASSERT_SAME( objs->max, quot );
+  ASSERT_SAME( objs->zero, rem );
+
+  // x / x == 1 remainder 0
+  quot = uint256_divmod( objs->max, objs->max, &rem );
+  ASSERT_SAME( objs->one, quot );
+  ASSERT_SAME( objs->zero, rem );
+
+  // smaller / larger == 0 remainder smaller
+  quot = uint256_divmod( objs->one, objs->msb_set, &rem );
+  ASSERT_SAME( objs->zero, quot );
+  ASSERT_SAME( objs->one, rem );
+
+  // max / 2^255 == 1 remainder 2^255 - 1
+  UInt256 below_msb = uint256_sub( objs->msb_set, objs->one );
+  quot = uint256_divmod( objs->max, objs->msb_set, &rem );
+  ASSERT_SAME( objs->one, quot );
+  ASSERT_SAME( below_msb, rem );
+
+  // remainder pointer is optional
+  quot = uint256_divmod( objs->max, uint256_create_from_u32( 2U ), NULL );
+  ASSERT_SAME( below_msb, quot );
+}
+
+void test_divmod_random( TestObjs *objs ) {
+  // check num == quot * den + rem and rem < den
+  for ( int i = 0; i < 2000; ++i ) {
+    UInt256 num = random_operand();
+    UInt256 den = random_operand();
+    if ( uint256_cmp( den, objs->zero ) == 0 )
+      continue;
+    UInt256 rem;
+    UInt256 quot = uint256_divmod( num, den, &rem );
+    ASSERT( uint256_cmp( rem, den ) < 0 );
+    ASSERT( !uint256_mul_overflows( quot, den ) );
+    ASSERT_SAME( num, uint256_add( uint256_mul( quot, den ), rem ) );
+  }
+}
+
+void test_divmod_u64( TestObjs *objs ) {
+  char *s;
+  uint64_t rem;
+  UInt256 quot;
+
+  quot = uint256_divmod_u64( objs->max, 10000000000000000000ULL, &rem );
+  s = uint256_format_as_hex( quot );
+  ASSERT( 0 == strcmp( "1d83c94fb6d2ac34a5663d3c7a0d865ca3c4ca40e0ea7cfe9", s ) );
+  free( s );
+  ASSERT( 0x693fcf03e3d7ffffULL == rem );
+
+  quot = uint256_divmod_u64( objs->zero, 7, &rem );
+  ASSERT_SAME( objs->zero, quot );
+  ASSERT( 0 == rem );
+
+  quot = uint256_divmod_u64( objs->max, 1, &rem );
+  ASSERT_SAME( objs->max, quot );
+  ASSERT( 0 == rem );
+
+  // agrees with the general divmod on random inputs
+  for ( int i = 0; i < 500; ++i ) {
+    UInt256 num = random_operand();
+    uint64_t den = test_rand() >> (test_rand() % 64);
+    if ( den == 0 )
+      continue;
+    UInt256 full_rem;
+    UInt256 den256 = {{ (uint32_t) den, (uint32_t) (den >> 32), 0, 0, 0, 0, 0, 0 }};
+    UInt256 expected = uint256_divmod( num, den256, &full_rem );
+    quot = uint256_divmod_u64( num, den, &rem );
+    ASSERT_SAME( expected, quot );
+    ASSERT( (uint32_t) rem == full_rem.data[0] );
+    ASSERT( (uint32_t) (rem >> 32) == full_rem.data[1] );
+  }
+}
+
+void test_mont_ctx_init( TestObjs *objs ) {
+  UInt256MontCtx ctx;
+
+  // even moduli and 1 are rejected
+  ASSERT( !uint256_mont_ctx_init( &ctx, objs->zero ) );
+  ASSERT( !uint256_mont_ctx_init( &ctx, objs->one ) );
+  ASSERT( !uint256_mont_ctx_init( &ctx, objs->msb_set ) );
+
+  // p = 2^255 - 19: R mod p == 38, R^2 mod p == 0x5a4
+  UInt256 p = uint256_create_from_hex( "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed" );
+  ASSERT( uint256_mont_ctx_init( &ctx, p ) );
+  ASSERT_SAME( uint256_create_from_u32( 38U ), ctx.one );
+  ASSERT_SAME( uint256_create_from_u32( 0x5a4U ), ctx.r2 );
+  ASSERT_SAME( ctx.one, uint256_to_mont( &ctx, objs->one ) );
+  ASSERT_SAME( objs->one, uint256_from_mont( &ctx, ctx.one ) );
+
+  // the largest possible modulus
+  ASSERT( uint256_mont_ctx_init( &ctx, objs->max ) );
+  ASSERT_SAME( objs->one, ctx.one );
+}
+
+void test_mont_mul( TestObjs *objs ) {
+  char *s;
+  UInt256MontCtx ctx;
+  UInt256 p = uint256_create_from_hex( "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed" );
+  ASSERT( uint256_mont_ctx_init( &ctx, p ) );
+
+  // the first operand is >= p; to_mont reduces it
+  UInt256 a = uint256_create_from_hex( "73ab48767734d7c1c7fde805ec99108ddb5b5fab8f4d3e27dda1494c73cf256d" );
+  UInt256 b = uint256_create_from_hex( "79cb9e86830c71c2cdcc69292f45e678309d6b79965eda32dae445508201e2bd" );
+  UInt256 am = uint256_to_mont( &ctx, a );
+  UInt256 bm = uint256_to_mont( &ctx, b );
+  UInt256 result = uint256_from_mont( &ctx, uint256_mont_mul( &ctx, am, bm ) );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "b5dfc558c2ddcbb3e350cf77fd400575f580a11f93cf43efe058cfa7df85175", s ) );
+  free( s );
+
+  // (p - 1)^2 == 1 (mod p)
+  UInt256 pm1 = uint256_to_mont( &ctx, uint256_sub( p, objs->one ) );
+  ASSERT_SAME( objs->one, uint256_from_mont( &ctx, uint256_mont_sqr( &ctx, pm1 ) ) );
+  ASSERT_SAME( objs->one, uint256_from_mont( &ctx, uint256_mont_mul( &ctx, pm1, pm1 ) ) );
+
+  // (p - 1) + 1 == 0 and 0 - 1 == p - 1
+  UInt256 one = uint256_to_mont( &ctx, objs->one );
+  ASSERT_SAME( objs->zero, uint256_mont_add( &ctx, pm1, one ) );
+  ASSERT_SAME( pm1, uint256_mont_sub( &ctx, objs->zero, one ) );
+}
+
+void test_mont_random( TestObjs *objs ) {
+  UInt256MontCtx ctx;
+  (void) objs;
+
+  for ( int i = 0; i < 200; ++i ) {
+    UInt256 m = random_operand();
+    m.data[0] |= 1U;
+    if ( !uint256_mont_ctx_init( &ctx, m ) )
+      continue;
+
+    for ( int j = 0; j < 10; ++j ) {
+      UInt256 a = uint256_mod( random_operand(), m );
+      UInt256 b = uint256_mod( random_operand(), m );
+      UInt256 am = uint256_to_mont( &ctx, a );
+      UInt256 bm = uint256_to_mont( &ctx, b );
+      ASSERT( uint256_cmp( am, m ) < 0 );
+      ASSERT_SAME( a, uint256_from_mont( &ctx, am ) );
+
+      UInt256 expected = uint512_mod( uint256_mul_wide( a, b ), m );
+      ASSERT_SAME( expected, uint256_from_mont( &ctx, uint256_mont_mul( &ctx, am, bm ) ) );
+
+      expected = uint512_mod( uint256_mul_wide( a, a ), m );
+      ASSERT_SAME( expected, uint256_from_mont( &ctx, uint256_mont_sqr( &ctx, am ) ) );
+
+      UInt256 sum = uint256_mont_add( &ctx, a, b );
+      ASSERT( uint256_cmp( sum, m ) < 0 );
+      ASSERT_SAME( a, uint256_mont_sub( &ctx, sum, b ) );
+      if ( uint256_cmp( uint256_add( a, b ), a ) >= 0 )
+        ASSERT_SAME( uint256_mod( uint256_add( a, b ), m ), sum );
+    }
+  }
+}
+
+void test_modexp( TestObjs *objs ) {
+  char *s;
+  UInt256 p = uint256_create_from_hex( "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed" );
+  UInt256 base = uint256_create_from_hex( "73ab48767734d7c1c7fde805ec99108ddb5b5fab8f4d3e27dda1494c73cf256d" );
+  UInt256 exp = uint256_create_from_hex( "79cb9e86830c71c2cdcc69292f45e678309d6b79965eda32dae445508201e2bd" );
+  UInt256 result;
+
+  result = uint256_modexp( base, exp, p );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "23118786c9a613788a648c93e4e126bc2ae8aa6f20699f93e7f7dcaf1ea0c4b8", s ) );
+  free( s );
+  ASSERT_SAME( result, uint256_modexp_ct( base, exp, p ) );
+
+  // Fermat: a^(p-1) == 1 (mod p)
+  UInt256 pm1 = uint256_sub( p, objs->one );
+  ASSERT_SAME( objs->one, uint256_modexp( base, pm1, p ) );
+  ASSERT_SAME( objs->one, uint256_modexp_ct( base, pm1, p ) );
+
+  // x^0 == 1, 0^x == 0, x^1 == x mod m, anything mod 1 == 0
+  ASSERT_SAME( objs->one, uint256_modexp( base, objs->zero, p ) );
+  ASSERT_SAME( objs->one, uint256_modexp_ct( base, objs->zero, p ) );
+  ASSERT_SAME( objs->zero, uint256_modexp( objs->zero, exp, p ) );
+  ASSERT_SAME( objs->zero, uint256_modexp_ct( objs->zero, exp, p ) );
+  ASSERT_SAME( uint256_mod( base, p ), uint256_modexp( base, objs->one, p ) );
+  ASSERT_SAME( objs->zero, uint256_modexp( base, exp, objs->one ) );
+
+  // even modulus
+  UInt256 m = uint256_create_from_hex( "d8d1d910fc0177a85db706b0cca8d00c14d08b859857b4c778f6808a900e0c" );
+  result = uint256_modexp( base, exp, m );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "6428e011916678815332e08b5b53b56ac64714fb0166daf0f8bfa115771081", s ) );
+  free( s );
+  result = uint256_modexp( uint256_create_from_u32( 3U ), objs->max, m );
+  s = uint256_format_as_hex( result );
+  ASSERT( 0 == strcmp( "d3d2d23134b9e97d1194f9a15c3c36f7c29de98bf19b16327d374d9efc8733", s ) );
+  free( s );
+
+  // powers of two modulo 2^255: 2^254 fits, 2^255 wraps to 0
+  ASSERT_SAME( uint256_lshift( objs->one, 254 ),
+               uint256_modexp( uint256_create_from_u32( 2U ), uint256_create_from_u32( 254U ), objs->msb_set ) );
+  ASSERT_SAME( objs->zero,
+               uint256_modexp( uint256_create_from_u32( 2U ), uint256_create_from_u32( 255U ), objs->msb_set ) );
+}
+
+void test_modexp_random( TestObjs *objs ) {
+  for ( int i = 0; i < 40; ++i ) {
+    UInt256 m = random_operand();
+    if ( uint256_cmp( m, objs->one ) <= 0 )
+      continue;
+    UInt256 base = random_operand();
+    UInt256 exp = random_operand();
+
+    // reference: right-to-left square-and-multiply, one bit at a time
+    UInt256 expected = uint256_mod( objs->one, m );
+    UInt256 sq = uint256_mod( base, m );
+    for ( unsigned bit = 0; bit < 256; ++bit ) {
+      if ( uint256_is_bit_set( exp, bit ) )
+        expected = uint512_mod( uint256_mul_wide( expected, sq ), m );
+      sq = uint512_mod( uint256_mul_wide( sq, sq ), m );
+    }
+
+    ASSERT_SAME( expected, uint256_modexp( base, exp, m ) );
+    if ( m.data[0] & 1U )
+      ASSERT_SAME( expected, uint256_modexp_ct( base, exp, m ) );
+  }
+}
+
+void test_barrett( TestObjs *objs ) {
+  UInt256BarrettCtx ctx;
+  UInt256 a = uint256_create_from_hex( "73ab48767734d7c1c7fde805ec99108ddb5b5fab8f4d3e27dda1494c73cf256d" );
+  UInt256 b = uint256_create_from_hex( "79cb9e86830c71c2cdcc69292f45e678309d6b79965eda32dae445508201e2bd" );
+  UInt512 wide = uint256_mul_wide( a, b );
+
+  ASSERT( !uint256_barrett_ctx_init( &ctx, objs->zero ) );
+
+  // everything is 0 mod 1
+  ASSERT( uint256_barrett_ctx_init( &ctx, objs->one ) );
+  ASSERT_SAME( objs->zero, uint256_barrett_reduce( &ctx, wide ) );
+  ASSERT_SAME( objs->zero, uint256_barrett_mul( &ctx, objs->zero, objs->zero ) );
+
+  // power-of-two modulus keeps the low bits
+  ASSERT( uint256_barrett_ctx_init( &ctx, objs->msb_set ) );
+  UInt256 low = uint512_lo( wide );
+  low.data[7] &= 0x7fffffffU;
+  ASSERT_SAME( low, uint256_barrett_reduce( &ctx, wide ) );
+
+  // largest modulus, including the unreduced max * max product
+  ASSERT( uint256_barrett_ctx_init( &ctx, objs->max ) );
+  ASSERT_SAME( uint512_mod( wide, objs->max ), uint256_barrett_reduce( &ctx, wide ) );
+  ASSERT_SAME( objs->zero, uint256_barrett_mul( &ctx, objs->max, objs->max ) );
+
+  // even modulus, operands larger than it take the slow path
+  UInt256 m = uint256_create_from_hex( "d8d1d910fc0177a85db706b0cca8d00c14d08b859857b4c778f6808a900e0c" );
+  ASSERT( uint256_barrett_ctx_init( &ctx, m ) );
+  ASSERT_SAME( uint512_mod( wide, m ), uint256_barrett_reduce( &ctx, wide ) );
+  ASSERT_SAME( uint512_mod( wide, m ), uint256_barrett_mul( &ctx, a, b ) );
+}
+
+void test_barrett_random( TestObjs *objs ) {
+  UInt256BarrettCtx ctx;
+  (void) objs;
+
+  for ( int i = 0; i < 200; ++i ) {
+    UInt256 m = random_operand();
+    if ( !uint256_barrett_ctx_init( &ctx, m ) )
+      continue;
+
+    for ( int j = 0; j < 10; ++j ) {
+      // reduced operands (fast path)
+      UInt256 a = uint256_mod( random_operand(), m );
+      UInt256 b = uint256_mod( random_operand(), m );
+      UInt512 wide = uint256_mul_wide( a, b );
+      ASSERT_SAME( uint512_mod( wide, m ), uint256_barrett_mul( &ctx, a, b ) );
+
+      // arbitrary 512-bit values
+      wide = uint256_mul_wide( random_operand(), random_operand() );
+      ASSERT_SAME( uint512_mod( wide, m ), uint256_barrett_reduce( &ctx, wide ) );
+    }
+  }
+}
+
+void test_format_hex_into( TestObjs *objs ) {
+  char buf[UINT256_HEX_BUFSIZE];
+
+  ASSERT( 1 == uint256_format_hex_into( objs->zero, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "0", buf ) );
+
+  ASSERT( 1 == uint256_format_hex_into( objs->one, buf, 2 ) );
+  ASSERT( 0 == strcmp( "1", buf ) );
+
+  ASSERT( 64 == uint256_format_hex_into( objs->max, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", buf ) );
+
+  ASSERT( 64 == uint256_format_hex_into( objs->msb_set, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "8000000000000000000000000000000000000000000000000000000000000000", buf ) );
+
+  // digits straddling a limb boundary, leading zeros inside the top limb
+  UInt256 val = uint256_create_from_hex( "1000000000000000f" );
+  ASSERT( 17 == uint256_format_hex_into( val, buf, 18 ) );
+  ASSERT( 0 == strcmp( "1000000000000000f", buf ) );
+
+  // buffer one short: nothing but an empty string is written
+  ASSERT( 0 == uint256_format_hex_into( val, buf, 17 ) );
+  ASSERT( 0 == strcmp( "", buf ) );
+  ASSERT( 0 == uint256_format_hex_into( objs->zero, buf, 1 ) );
+  ASSERT( 0 == strcmp( "", buf ) );
+  ASSERT( 0 == uint256_format_hex_into( objs->zero, NULL, 0 ) );
+}
+
+void test_format_hex_into_random( TestObjs *objs ) {
+  char buf[UINT256_HEX_BUFSIZE];
+  (void) objs;
+
+  for ( int i = 0; i < 1000; ++i ) {
+    UInt256 val = random_operand();
+    size_t n = uint256_format_hex_into( val, buf, sizeof(buf) );
+    ASSERT( n == strlen( buf ) );
+    ASSERT( n == 1 || buf[0] != '0' );
+    ASSERT_SAME( val, uint256_create_from_hex( buf ) );
+  }
+}
+
+void test_dec_roundtrip( TestObjs *objs ) {
+  char buf[UINT256_DEC_BUFSIZE];
+  const char *max_dec = "115792089237316195423570985008687907853269984665640564039457584007913129639935";
+
+  ASSERT( 1 == uint256_format_dec_into( objs->zero, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "0", buf ) );
+  ASSERT_SAME( objs->zero, uint256_create_from_dec( "0" ) );
+
+  ASSERT( 1 == uint256_format_dec_into( objs->one, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "1", buf ) );
+  ASSERT_SAME( objs->one, uint256_create_from_dec( "1" ) );
+
+  ASSERT( 78 == uint256_format_dec_into( objs->max, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( max_dec, buf ) );
+  ASSERT_SAME( objs->max, uint256_create_from_dec( max_dec ) );
+
+  ASSERT( 77 == uint256_format_dec_into( objs->msb_set, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "57896044618658097711785492504343953926634992332820282019728792003956564819968", buf ) );
+  ASSERT_SAME( objs->msb_set, uint256_create_from_dec( buf ) );
+
+  // values around the 10^19 chunk size and the 2^64 limb size
+  UInt256 val = uint256_create_from_hex( "8ac7230489e7ffff" );
+  ASSERT( 19 == uint256_format_dec_into( val, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "9999999999999999999", buf ) );
+  ASSERT_SAME( val, uint256_create_from_dec( buf ) );
+
+  val = uint256_create_from_hex( "8ac7230489e80000" );
+  ASSERT( 20 == uint256_format_dec_into( val, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "10000000000000000000", buf ) );
+  ASSERT_SAME( val, uint256_create_from_dec( buf ) );
+
+  val = uint256_create_from_hex( "10000000000000000" );
+  ASSERT( 20 == uint256_format_dec_into( val, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "18446744073709551616", buf ) );
+  ASSERT_SAME( val, uint256_create_from_dec( buf ) );
+
+  // 10^38: a zero chunk in the middle must keep its padding
+  val = uint256_create_from_hex( "4b3b4ca85a86c47a098a224000000000" );
+  ASSERT( 39 == uint256_format_dec_into( val, buf, sizeof(buf) ) );
+  ASSERT( 0 == strcmp( "100000000000000000000000000000000000000", buf ) );
+  ASSERT_SAME( val, uint256_create_from_dec( buf ) );
+}
+
+void test_dec_edgecases( TestObjs *objs ) {
+  char buf[UINT256_DEC_BUFSIZE];
+
+  // empty input, leading zeros, trailing garbage
+  ASSERT_SAME( objs->zero, uint256_create_from_dec( "" ) );
+  ASSERT_SAME( objs->zero, uint256_create_from_dec( "x1" ) );
+  ASSERT_SAME( uint256_create_from_u32( 42U ), uint256_create_from_dec( "000000000000000000000000042" ) );
+  ASSERT_SAME( uint256_create_from_u32( 123U ), uint256_create_from_dec( "123abc" ) );
+  ASSERT_SAME( uint256_create_from_hex( "8ac7230489e80000" ), uint256_create_from_dec( "10000000000000000000 5" ) );
+
+  // 2^256 and 2^256 + 5 wrap around
+  ASSERT_SAME( objs->zero, uint256_create_from_dec( "115792089237316195423570985008687907853269984665640564039457584007913129639936" ) );
+  ASSERT_SAME( uint256_create_from_u32( 5U ), uint256_create_from_dec( "115792089237316195423570985008687907853269984665640564039457584007913129639941" ) );
+
+  // buffer too small
+  ASSERT( 0 == uint256_format_dec_into( objs->max, buf, 78 ) );
+  ASSERT( 0 == strcmp( "", buf ) );
+  ASSERT( 3 == uint256_format_dec_into( uint256_create_from_u32( 100U ), buf, 4 ) );
+  ASSERT( 0 == strcmp( "100", buf ) );
+  ASSERT( 0 == uint256_format_dec_into( uint256_create_from_u32( 100U ), buf, 3 ) );
+  ASSERT( 0 == uint256_format_dec_into( objs->zero, NULL, 0 ) );
+}
+
+void test_dec_random( TestObjs *objs ) {
+  char buf[UINT256_DEC_BUFSIZE];
+  (void) objs;
+
+  for ( int i = 0; i < 1000; ++i ) {
+    UInt256 val = random_operand();
+    size_t n = uint256_format_dec_into( val, buf, sizeof(buf) );
+    ASSERT( n == strlen( buf ) );
+    ASSERT( n == 1 || buf[0] != '0' );
+    ASSERT_SAME( val, uint256_create_from_dec( buf ) );
+
+    // the last digit is val mod 10
+    uint64_t rem;
+    uint256_divmod_u64( val, 10, &rem );
+    ASSERT( (char) ('0' + rem) == buf[n - 1] );
+  }
+}
+
+void test_parse_hex( TestObjs *objs ) {
+  UInt256 val;
+  const char *max_hex = "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff";
+
+  ASSERT( UINT256_OK == uint256_parse_hex( "0", 1, &val ) );
+  ASSERT_SAME( objs->zero, val );
+  ASSERT( UINT256_OK == uint256_parse_hex( "1", 1, &val ) );
+  ASSERT_SAME( objs->one, val );
+  ASSERT( UINT256_OK == uint256_parse_hex( max_hex, 64, &val ) );
+  ASSERT_SAME( objs->max, val );
+  ASSERT( UINT256_OK == uint256_parse_hex( "FFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffff", 64, &val ) );
+  ASSERT_SAME( objs->max, val );
+
+  // only len characters are read
+  ASSERT( UINT256_OK == uint256_parse_hex( "8000000000000000000000000000000000000000000000000000000000000000zz", 64, &val ) );
+  ASSERT_SAME( objs->msb_set, val );
+  ASSERT( UINT256_OK == uint256_parse_hex( "aBcDeF0123456789aBcDeF", 17, &val ) );
+  ASSERT_SAME( uint256_create_from_hex( "abcdef0123456789a" ), val );
+
+  // leading zeros beyond 64 digits are fine
+  ASSERT( UINT256_OK == uint256_parse_hex( "00000ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", 69, &val ) );
+  ASSERT_SAME( objs->max, val );
+
+  // failures leave the result alone
+  val = objs->one;
+  ASSERT( UINT256_ERR_EMPTY == uint256_parse_hex( "", 0, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( "12g4", 4, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( "0x1234", 6, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( " 1234", 5, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( "1234\n", 5, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( "12\0" "34", 5, &val ) );
+  ASSERT( UINT256_ERR_OVERFLOW == uint256_parse_hex( "1ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff", 65, &val ) );
+  ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( "g0000000000000000000000000000000000000000000000000000000000000000", 65, &val ) );
+  ASSERT_SAME( objs->one, val );
+
+  // the lenient parser stops at the first character that isn't a digit
+  ASSERT_SAME( uint256_create_from_hex( "12" ), uint256_create_from_hex( "12g4" ) );
+  ASSERT_SAME( uint256_create_from_hex( "1234" ), uint256_create_from_hex( "1234\n" ) );
+  ASSERT_SAME( objs->zero, uint256_create_from_hex( "g1234" ) );
+  ASSERT_SAME( objs->zero, uint256_create_from_hex( "" ) );
+}
+
+void test_parse_hex_random( TestObjs *objs ) {
+  char buf[UINT256_HEX_BUFSIZE];
+  (void) objs;
+
+  for ( int i = 0; i < 1000; ++i ) {
+    UInt256 val = random_operand(), parsed;
+    size_t n = uint256_format_hex_into( val, buf, sizeof(buf) );
+    ASSERT( UINT256_OK == uint256_parse_hex( buf, n, &parsed ) );
+    ASSERT_SAME( val, parsed );
+
+    // corrupt one character
+    size_t pos = test_rand() % n;
+    buf[pos] = "g-xG /:@`"[test_rand() % 9];
+    ASSERT( UINT256_ERR_INVALID == uint256_parse_hex( buf, n, &parsed ) );
+  }
+}
+
+void test_rshift( TestObjs *objs ) {
+  ASSERT_SAME( objs->max, uint256_rshift( objs->max, 0 ) );
+  ASSERT_SAME( objs->one, uint256_rshift( objs->msb_set, 255 ) );
+  ASSERT_SAME( objs->zero, uint256_rshift( objs->one, 1 ) );
+  ASSERT_SAME( uint256_create_from_hex( "1" ), uint256_rshift( objs->max, 255 ) );
+  ASSERT_SAME( uint256_create_from_hex( "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" ),
+               uint256_rshift( objs->max, 8 ) );
+
+  // whole-limb, whole-word and straddling shifts
+  UInt256 val = uint256_create_from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f0" );
+  ASSERT_SAME( uint256_create_from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a6978" ), uint256_rshift( val, 64 ) );
+  ASSERT_SAME( uint256_create_from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4" ), uint256_rshift( val, 32 ) );
+  ASSERT_SAME( uint256_create_from_hex( "91a2b3c4d5e6f7ff6e5d4c3b2a190" ), uint256_rshift( val, 133 ) );
+  ASSERT_SAME( uint256_create_from_hex( "12" ), uint256_rshift( val, 244 ) );
+}
+
+void test_rotate( TestObjs *objs ) {
+  ASSERT_SAME( objs->one, uint256_rotl( objs->msb_set, 1 ) );
+  ASSERT_SAME( objs->msb_set, uint256_rotr( objs->one, 1 ) );
+  ASSERT_SAME( objs->max, uint256_rotl( objs->max, 77 ) );
+  ASSERT_SAME( objs->one, uint256_rotl( objs->one, 0 ) );
+  ASSERT_SAME( objs->one, uint256_rotl( objs->one, 256 ) );
+  ASSERT_SAME( uint256_lshift( objs->one, 3 ), uint256_rotl( objs->one, 259 ) );
+  ASSERT_SAME( objs->one, uint256_rotr( objs->one, 512 ) );
+
+  UInt256 val = uint256_create_from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f0" );
+  ASSERT_SAME( uint256_create_from_hex( "23456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f001" ), uint256_rotl( val, 8 ) );
+  ASSERT_SAME( uint256_create_from_hex( "8796a5b4c3d2e1f00123456789abcdeffedcba98765432100f1e2d3c4b5a6978" ), uint256_rotr( val, 64 ) );
+}
+
+void test_bitwise( TestObjs *objs ) {
+  UInt256 a = uint256_create_from_hex( "ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00" );
+  UInt256 b = uint256_create_from_hex( "f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0" );
+
+  ASSERT_SAME( uint256_create_from_hex( "f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000" ), uint256_and( a, b ) );
+  ASSERT_SAME( uint256_create_from_hex( "fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0" ), uint256_or( a, b ) );
+  ASSERT_SAME( uint256_create_from_hex( "0ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff0" ), uint256_xor( a, b ) );
+  ASSERT_SAME( uint256_create_from_hex( "00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff" ), uint256_not( a ) );
+
+  ASSERT_SAME( objs->max, uint256_not( objs->zero ) );
+  ASSERT_SAME( objs->zero, uint256_xor( objs->max, objs->max ) );
+  ASSERT_SAME( objs->msb_set, uint256_and( objs->max, objs->msb_set ) );
+  ASSERT_SAME( objs->max, uint256_or( objs->max, objs->one ) );
+}
+
+void test_shift_random( TestObjs *objs ) {
+  for ( int i = 0; i < 500; ++i ) {
+    UInt256 val = random_operand(), other = random_operand();
+    unsigned shift = test_rand() % 256;
+
+    // rshift is division by a power of two, lshift multiplication
+    UInt256 pow2 = uint256_lshift( objs->one, shift );
+    ASSERT_SAME( uint256_div( val, pow2 ), uint256_rshift( val, shift ) );
+    ASSERT_SAME( uint256_mul( val, pow2 ), uint256_lshift( val, shift ) );
+
+    // rotations put back what the shifts drop
+    UInt256 rot = uint256_or( uint256_lshift( val, shift ),
+                              shift ? uint256_rshift( val, 256 - shift ) : objs->zero );
+    ASSERT_SAME( rot, uint256_rotl( val, shift ) );
+    ASSERT_SAME( val, uint256_rotr( uint256_rotl( val, shift ), shift ) );
+
+    // ~x == max - x, and a ^ b == (a | b) - (a & b)
+    ASSERT_SAME( uint256_sub( objs->max, val ), uint256_not( val ) );
+    ASSERT_SAME( uint256_sub( uint256_or( val, other ), uint256_and( val, other ) ),
+                 uint256_xor( val, other ) );
+  }
+}
+
+void test_inplace_ops( TestObjs *objs ) {
+  UInt256 result;
+
+  uint256_add_to( &result, &objs->max, &objs->one );
+  ASSERT_SAME( objs->zero, result );
+  uint256_sub_to( &result, &objs->zero, &objs->one );
+  ASSERT_SAME( objs->max, result );
+  uint256_negate_to( &result, &objs->one );
+  ASSERT_SAME( objs->max, result );
+  uint256_mul_to( &result, &objs->max, &objs->max );
+  ASSERT_SAME( objs->one, result );
+  uint256_sqr_to( &result, &objs->msb_set );
+  ASSERT_SAME( objs->zero, result );
+  uint256_lshift_to( &result, &objs->one, 255 );
+  ASSERT_SAME( objs->msb_set, result );
+  uint256_rshift_to( &result, &objs->msb_set, 255 );
+  ASSERT_SAME( objs->one, result );
+  uint256_and_to( &result, &objs->max, &objs->msb_set );
+  ASSERT_SAME( objs->msb_set, result );
+  uint256_or_to( &result, &objs->zero, &objs->one );
+  ASSERT_SAME( objs->one, result );
+  uint256_xor_to( &result, &objs->max, &objs->max );
+  ASSERT_SAME( objs->zero, result );
+  uint256_not_to( &result, &objs->zero );
+  ASSERT_SAME( objs->max, result );
+
+  // accumulate in place: 1 + 2 + ... + 100
+  UInt256 acc = objs->zero;
+  for ( uint32_t i = 1; i <= 100; ++i ) {
+    UInt256 term = uint256_create_from_u32( i );
+    uint256_add_to( &acc, &acc, &term );
+  }
+  ASSERT_SAME( uint256_create_from_u32( 5050U ), acc );
+}
+
+void test_inplace_aliasing( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int i = 0; i < 200; ++i ) {
+    UInt256 a = random_operand(), b = random_operand(), r;
+    unsigned shift = test_rand() % 256;
+
+    // dst aliasing the first operand, the second, and both
+    r = a; uint256_add_to( &r, &r, &b ); ASSERT_SAME( uint256_add( a, b ), r );
+    r = b; uint256_add_to( &r, &a, &r ); ASSERT_SAME( uint256_add( a, b ), r );
+    r = a; uint256_add_to( &r, &r, &r ); ASSERT_SAME( uint256_add( a, a ), r );
+    r = a; uint256_sub_to( &r, &r, &b ); ASSERT_SAME( uint256_sub( a, b ), r );
+    r = b; uint256_sub_to( &r, &a, &r ); ASSERT_SAME( uint256_sub( a, b ), r );
+    r = a; uint256_sub_to( &r, &r, &r ); ASSERT_SAME( uint256_create_from_u32( 0 ), r );
+    r = a; uint256_negate_to( &r, &r ); ASSERT_SAME( uint256_negate( a ), r );
+    r = a; uint256_mul_to( &r, &r, &b ); ASSERT_SAME( uint256_mul( a, b ), r );
+    r = b; uint256_mul_to( &r, &a, &r ); ASSERT_SAME( uint256_mul( a, b ), r );
+    r = a; uint256_mul_to( &r, &r, &r ); ASSERT_SAME( uint256_mul( a, a ), r );
+    r = a; uint256_sqr_to( &r, &r ); ASSERT_SAME( uint256_sqr( a ), r );
+    r = a; uint256_lshift_to( &r, &r, shift ); ASSERT_SAME( uint256_lshift( a, shift ), r );
+    r = a; uint256_rshift_to( &r, &r, shift ); ASSERT_SAME( uint256_rshift( a, shift ), r );
+    r = a; uint256_and_to( &r, &r, &b ); ASSERT_SAME( uint256_and( a, b ), r );
+    r = b; uint256_or_to( &r, &a, &r ); ASSERT_SAME( uint256_or( a, b ), r );
+    r = a; uint256_xor_to( &r, &r, &b ); ASSERT_SAME( uint256_xor( a, b ), r );
+    r = a; uint256_not_to( &r, &r ); ASSERT_SAME( uint256_not( a ), r );
+  }
+}
+
+void test_inline_ops( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int i = 0; i < 200; ++i ) {
+    UInt256 a = random_operand(), b = random_operand(), r;
+
+    r = a; uint256_add_inline( &r, &r, &b ); ASSERT_SAME( uint256_add( a, b ), r );
+    r = b; uint256_sub_inline( &r, &a, &r ); ASSERT_SAME( uint256_sub( a, b ), r );
+    r = a; uint256_negate_inline( &r, &r ); ASSERT_SAME( uint256_negate( a ), r );
+    r = a; uint256_and_inline( &r, &r, &b ); ASSERT_SAME( uint256_and( a, b ), r );
+    r = a; uint256_or_inline( &r, &r, &b ); ASSERT_SAME( uint256_or( a, b ), r );
+    r = a; uint256_xor_inline( &r, &r, &b ); ASSERT_SAME( uint256_xor( a, b ), r );
+    r = a; uint256_not_inline( &r, &r ); ASSERT_SAME( uint256_not( a ), r );
+
+    int c = uint256_cmp_inline( &a, &b );
+    ASSERT( c == uint256_cmp( a, b ) );
+    ASSERT( -c == uint256_cmp_inline( &b, &a ) );
+    ASSERT( 0 == uint256_cmp_inline( &a, &a ) );
+  }
+}
+
+void test_batch_carries( TestObjs *objs ) {
+  // one full SIMD block plus a scalar tail, with carries and borrows
+  // that ripple through every limb in some lanes but not others
+  UInt256 a[5] = { objs->max, objs->zero, objs->max, objs->one, objs->msb_set };
+  UInt256 b[5] = { objs->one, objs->one, objs->max, objs->max, objs->msb_set };
+  UInt256 dst[5];
+
+  uint256_add_batch( 5, dst, a, b );
+  ASSERT_SAME( objs->zero, dst[0] );
+  ASSERT_SAME( objs->one, dst[1] );
+  ASSERT_SAME( uint256_sub( objs->max, objs->one ), dst[2] );
+  ASSERT_SAME( objs->zero, dst[3] );
+  ASSERT_SAME( objs->zero, dst[4] );
+
+  uint256_sub_batch( 5, dst, a, b );
+  ASSERT_SAME( uint256_sub( objs->max, objs->one ), dst[0] );
+  ASSERT_SAME( objs->max, dst[1] );
+  ASSERT_SAME( objs->zero, dst[2] );
+  ASSERT_SAME( uint256_create_from_u32( 2U ), dst[3] );
+  ASSERT_SAME( objs->zero, dst[4] );
+
+  uint256_mul_batch( 5, dst, a, b );
+  ASSERT_SAME( objs->max, dst[0] );
+  ASSERT_SAME( objs->zero, dst[1] );
+  ASSERT_SAME( objs->one, dst[2] );
+  ASSERT_SAME( objs->max, dst[3] );
+  ASSERT_SAME( objs->zero, dst[4] );
+
+  // n == 0 touches nothing
+  dst[0] = objs->one;
+  uint256_add_batch( 0, dst, a, b );
+  ASSERT_SAME( objs->one, dst[0] );
+}
+
+void test_batch_random( TestObjs *objs ) {
+  UInt256 a[37], b[37], dst[37];
+  (void) objs;
+
+  // every length up to a few blocks, so each tail size is covered
+  for ( size_t n = 1; n <= 37; ++n ) {
+    for ( size_t i = 0; i < n; ++i ) {
+      a[i] = random_operand();
+      b[i] = random_operand();
+    }
+    uint256_add_batch( n, dst, a, b );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( uint256_add( a[i], b[i] ), dst[i] );
+    uint256_sub_batch( n, dst, a, b );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( uint256_sub( a[i], b[i] ), dst[i] );
+    uint256_mul_batch( n, dst, a, b );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( uint256_mul( a[i], b[i] ), dst[i] );
+
+    // in place: a += b
+    for ( size_t i = 0; i < n; ++i )
+      dst[i] = a[i];
+    uint256_add_batch( n, a, a, b );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( uint256_add( dst[i], b[i] ), a[i] );
+  }
+}
+
+void test_acc_carries( TestObjs *objs ) {
+  UInt256Accumulator acc;
+  UInt256 vals[3] = { objs->max, objs->max, objs->max };
+  uint64_t wraps;
+
+  uint256_acc_init( &acc );
+  ASSERT_SAME( objs->zero, uint256_acc_value( &acc, &wraps ) );
+  ASSERT( 0 == wraps );
+
+  // 5 * (2^256 - 1) = 4 * 2^256 + (2^256 - 5)
+  uint256_acc_add( &acc, &objs->max );
+  uint256_acc_add( &acc, &objs->max );
+  uint256_acc_add_array( &acc, vals, 3 );
+  ASSERT_SAME( uint256_sub( objs->zero, uint256_create_from_u32( 5U ) ), uint256_acc_value( &acc, &wraps ) );
+  ASSERT( 4 == wraps );
+
+  // reading the value doesn't disturb further accumulation
+  uint256_acc_add( &acc, &objs->one );
+  uint256_acc_add( &acc, &objs->one );
+  ASSERT_SAME( uint256_sub( objs->zero, uint256_create_from_u32( 3U ) ), uint256_acc_value( &acc, NULL ) );
+
+  // (2^256 - 1)^2 == 1 mod 2^256, three times over
+  uint256_acc_init( &acc );
+  uint256_acc_dot( &acc, vals, vals, 3 );
+  ASSERT_SAME( uint256_create_from_u32( 3U ), uint256_acc_value( &acc, &wraps ) );
+  ASSERT( 0 == wraps );
+  uint256_acc_mul_add( &acc, &objs->msb_set, &objs->one );
+  uint256_acc_mul_add( &acc, &objs->msb_set, &objs->one );
+  ASSERT_SAME( uint256_create_from_u32( 3U ), uint256_acc_value( &acc, &wraps ) );
+  ASSERT( 1 == wraps );
+
+  // run out of headroom partway through an array (the room is an
+  // internal detail, shrunk here so the test doesn't need 2^32 adds)
+  uint256_acc_init( &acc );
+  acc.room = 2;
+  uint256_acc_add_array( &acc, vals, 3 );
+  acc.room = 0;
+  uint256_acc_add( &acc, &objs->max );
+  ASSERT_SAME( uint256_sub( objs->zero, uint256_create_from_u32( 4U ) ), uint256_acc_value( &acc, &wraps ) );
+  ASSERT( 3 == wraps );
+}
+
+void test_acc_random( TestObjs *objs ) {
+  UInt256 a[40], b[40];
+  (void) objs;
+
+  for ( int iter = 0; iter < 50; ++iter ) {
+    UInt256Accumulator acc, dot;
+    UInt256 sum = uint256_create_from_u32( 0U ), dsum = sum;
+    uint64_t wraps = 0, w;
+    size_t n = 1 + test_rand() % 40;
+
+    uint256_acc_init( &acc );
+    uint256_acc_init( &dot );
+    // a small room forces normalizations at varying points
+    acc.room = dot.room = 1 + test_rand() % 8;
+    for ( size_t i = 0; i < n; ++i ) {
+      a[i] = random_operand();
+      b[i] = random_operand();
+      sum = uint256_add( sum, a[i] );
+      wraps += uint256_cmp( sum, a[i] ) < 0;
+      dsum = uint256_add( dsum, uint256_mul( a[i], b[i] ) );
+    }
+
+    // split the array between single adds and an array add
+    size_t split = test_rand() % (n + 1);
+    for ( size_t i = 0; i < split; ++i )
+      uint256_acc_add( &acc, &a[i] );
+    uint256_acc_add_array( &acc, a + split, n - split );
+    ASSERT_SAME( sum, uint256_acc_value( &acc, &w ) );
+    ASSERT( wraps == w );
+
+    uint256_acc_dot( &dot, a, b, split );
+    for ( size_t i = split; i < n; ++i )
+      uint256_acc_mul_add( &dot, &a[i], &b[i] );
+    ASSERT_SAME( dsum, uint256_acc_value( &dot, NULL ) );
+  }
+}
+
+void test_bit_scan( TestObjs *objs ) {
+  ASSERT( 0 == uint256_bit_length( objs->zero ) );
+  ASSERT( 256 == uint256_clz( objs->zero ) );
+  ASSERT( 256 == uint256_ctz( objs->zero ) );
+  ASSERT( 0 == uint256_popcount( objs->zero ) );
+  ASSERT( 256 == uint256_next_set_bit( objs->zero, 0 ) );
+
+  ASSERT( 1 == uint256_bit_length( objs->one ) );
+  ASSERT( 255 == uint256_clz( objs->one ) );
+  ASSERT( 0 == uint256_ctz( objs->one ) );
+  ASSERT( 1 == uint256_popcount( objs->one ) );
+  ASSERT( 0 == uint256_next_set_bit( objs->one, 0 ) );
+  ASSERT( 256 == uint256_next_set_bit( objs->one, 1 ) );
+
+  ASSERT( 256 == uint256_bit_length( objs->max ) );
+  ASSERT( 0 == uint256_clz( objs->max ) );
+  ASSERT( 256 == uint256_popcount( objs->max ) );
+  ASSERT( 200 == uint256_next_set_bit( objs->max, 200 ) );
+  ASSERT( 256 == uint256_next_set_bit( objs->max, 256 ) );
+  ASSERT( 256 == uint256_next_set_bit( objs->max, 1000 ) );
+
+  ASSERT( 256 == uint256_bit_length( objs->msb_set ) );
+  ASSERT( 255 == uint256_ctz( objs->msb_set ) );
+  ASSERT( 255 == uint256_next_set_bit( objs->msb_set, 64 ) );
+
+  // bits 3, 64, 127 and 128: limb boundaries on both sides
+  UInt256 val = uint256_create_from_hex( "1" "8000000000000001" "0000000000000008" );
+  ASSERT( 129 == uint256_bit_length( val ) );
+  ASSERT( 127 == uint256_clz( val ) );
+  ASSERT( 3 == uint256_ctz( val ) );
+  ASSERT( 4 == uint256_popcount( val ) );
+  ASSERT( 3 == uint256_next_set_bit( val, 0 ) );
+  ASSERT( 64 == uint256_next_set_bit( val, 4 ) );
+  ASSERT( 127 == uint256_next_set_bit( val, 65 ) );
+  ASSERT( 128 == uint256_next_set_bit( val, 128 ) );
+  ASSERT( 256 == uint256_next_set_bit( val, 129 ) );
+}
+
+void test_bit_scan_random( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int iter = 0; iter < 200; ++iter ) {
+    UInt256 val = random_operand();
+    // sparse values too, so the zero-limb skipping gets exercised
+    if ( iter % 2 == 0 )
+      val = uint256_and( val, uint256_lshift( random_operand(), test_rand() % 256 ) );
+
+    unsigned count = 0, highest = 0, lowest = 256;
+    for ( unsigned i = 0; i < 256; ++i ) {
+      if ( uint256_is_bit_set( val, i ) ) {
+        ++count;
+        highest = i + 1;
+        if ( lowest == 256 )
+          lowest = i;
+      }
+    }
+    ASSERT( highest == uint256_bit_length( val ) );
+    ASSERT( 256 - highest == uint256_clz( val ) );
+    ASSERT( lowest == uint256_ctz( val ) );
+    ASSERT( count == uint256_popcount( val ) );
+
+    // walking the set bits visits exactly the bits is_bit_set reports
+    unsigned next = 0;
+    for ( unsigned i = uint256_next_set_bit( val, 0 ); i < 256; i = uint256_next_set_bit( val, i + 1 ) ) {
+      for ( ; next < i; ++next )
+        ASSERT( !uint256_is_bit_set( val, next ) );
+      ASSERT( uint256_is_bit_set( val, i ) );
+      ++next;
+      --count;
+    }
+    ASSERT( 0 == count );
+  }
+}
+
+// Euclid's algorithm by repeated uint256_mod, as a reference
+static UInt256 reference_gcd( UInt256 a, UInt256 b ) {
+  UInt256 zero = uint256_create_from_u32( 0U );
+  while ( uint256_cmp( b, zero ) != 0 ) {
+    UInt256 r = uint256_mod( a, b );
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+void test_gcd( TestObjs *objs ) {
+  ASSERT_SAME( objs->zero, uint256_gcd( objs->zero, objs->zero ) );
+  ASSERT_SAME( objs->max, uint256_gcd( objs->zero, objs->max ) );
+  ASSERT_SAME( objs->msb_set, uint256_gcd( objs->msb_set, objs->zero ) );
+  ASSERT_SAME( objs->one, uint256_gcd( objs->max, objs->msb_set ) );
+  ASSERT_SAME( objs->max, uint256_gcd( objs->max, objs->max ) );
+
+  // 2^100 * 3 and 2^200 * 9 share 2^100 * 3
+  UInt256 a = uint256_lshift( uint256_create_from_u32( 3U ), 100 );
+  UInt256 b = uint256_lshift( uint256_create_from_u32( 9U ), 200 );
+  ASSERT_SAME( a, uint256_gcd( a, b ) );
+  ASSERT_SAME( a, uint256_gcd( b, a ) );
+
+  // consecutive Fibonacci numbers are coprime (and the worst case
+  // for Euclid)
+  UInt256 f0 = objs->zero, f1 = objs->one;
+  while ( uint256_bit_length( f1 ) < 255 ) {
+    UInt256 f2 = uint256_add( f0, f1 );
+    f0 = f1;
+    f1 = f2;
+  }
+  ASSERT_SAME( objs->one, uint256_gcd( f0, f1 ) );
+
+  // equal top bits but opposite order in the low bits, so the
+  // word-sized approximations compare the wrong way
+  a = uint256_add( uint256_add( uint256_lshift( objs->one, 200 ), uint256_lshift( objs->one, 150 ) ), objs->one );
+  b = uint256_add( uint256_lshift( objs->one, 200 ), uint256_create_from_u32( 3U ) );
+  ASSERT_SAME( reference_gcd( a, b ), uint256_gcd( a, b ) );
+  ASSERT_SAME( reference_gcd( b, a ), uint256_gcd( b, a ) );
+  a = uint256_mul( a, uint256_create_from_u32( 15U ) );
+  b = uint256_mul( b, uint256_create_from_u32( 35U ) );
+  ASSERT_SAME( reference_gcd( a, b ), uint256_gcd( a, b ) );
+}
+
+void test_gcd_random( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int iter = 0; iter < 300; ++iter ) {
+    UInt256 a = random_operand(), b = random_operand();
+    // give some pairs a large common factor
+    if ( iter % 3 == 0 ) {
+      UInt256 k = uint256_rshift( random_operand(), 128 );
+      a = uint256_mul( uint256_rshift( a, 128 ), k );
+      b = uint256_mul( uint256_rshift( b, 128 ), k );
+    }
+    UInt256 g = uint256_gcd( a, b );
+    ASSERT_SAME( reference_gcd( a, b ), g );
+    ASSERT_SAME( g, uint256_gcd( b, a ) );
+  }
+}
+
+// Check that r == isqrt( n ), i.e. r^2 <= n < (r + 1)^2
+static int is_isqrt( UInt256 n, UInt256 r ) {
+  UInt256 zero = uint256_create_from_u32( 0U );
+  UInt256 r1 = uint256_add( r, uint256_create_from_u32( 1U ) );
+  UInt512 sq = uint256_mul_wide( r, r ), sq1 = uint256_mul_wide( r1, r1 );
+  if ( uint256_cmp( uint512_hi( sq ), zero ) != 0 || uint256_cmp( uint512_lo( sq ), n ) > 0 )
+    return 0;
+  return uint256_cmp( uint512_hi( sq1 ), zero ) != 0 || uint256_cmp( uint512_lo( sq1 ), n ) > 0;
+}
+
+void test_isqrt( TestObjs *objs ) {
+  ASSERT_SAME( objs->zero, uint256_isqrt( objs->zero ) );
+  ASSERT_SAME( objs->one, uint256_isqrt( objs->one ) );
+  ASSERT_SAME( objs->one, uint256_isqrt( uint256_create_from_u32( 3U ) ) );
+  ASSERT_SAME( uint256_create_from_u32( 2U ), uint256_isqrt( uint256_create_from_u32( 4U ) ) );
+  ASSERT_SAME( uint256_create_from_u32( 0xffffffffU ), uint256_isqrt( uint256_create_from_hex( "ffffffffffffffff" ) ) );
+  ASSERT_SAME( uint256_create_from_hex( "100000000" ), uint256_isqrt( uint256_create_from_hex( "10000000000000000" ) ) );
+
+  // 2^256 - 1 is just below (2^128)^2
+  ASSERT_SAME( uint256_create_from_hex( "ffffffffffffffffffffffffffffffff" ), uint256_isqrt( objs->max ) );
+  ASSERT_SAME( uint256_create_from_hex( "b504f333f9de6484597d89b3754abe9f" ), uint256_isqrt( objs->msb_set ) );
+}
+
+void test_isqrt_random( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int iter = 0; iter < 300; ++iter ) {
+    UInt256 n = random_operand();
+    ASSERT( is_isqrt( n, uint256_isqrt( n ) ) );
+
+    // perfect squares and their neighbours
+    UInt256 x = uint256_rshift( random_operand(), 128 );
+    UInt256 sq = uint256_mul( x, x );
+    ASSERT_SAME( x, uint256_isqrt( sq ) );
+    if ( uint256_bit_length( x ) > 0 )
+      ASSERT( is_isqrt( uint256_sub( sq, objs->one ), uint256_sub( x, objs->one ) ) );
+    ASSERT( is_isqrt( uint256_sub( sq, objs->one ), uint256_isqrt( uint256_sub( sq, objs->one ) ) ) );
+  }
+}
+
+// val * inv == 1 (mod mod)
+static int is_modinv( UInt256 val, UInt256 inv, UInt256 mod ) {
+  UInt256 one = uint256_create_from_u32( 1U );
+  return uint256_cmp( inv, mod ) < 0
+    && uint256_cmp( uint512_mod( uint256_mul_wide( uint256_mod( val, mod ), inv ), mod ), one ) == 0;
+}
+
+void test_modinv( TestObjs *objs ) {
+  UInt256 p = uint256_create_from_hex( "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed" );
+  UInt256 inv = objs->zero;
+
+  ASSERT( uint256_modinv( uint256_create_from_u32( 3U ), uint256_create_from_u32( 7U ), &inv ) );
+  ASSERT_SAME( uint256_create_from_u32( 5U ), inv );
+  ASSERT( uint256_modinv( uint256_create_from_u32( 3U ), uint256_create_from_u32( 8U ), &inv ) );
+  ASSERT_SAME( uint256_create_from_u32( 3U ), inv );
+
+  // 2^-1 mod p is (p + 1) / 2
+  ASSERT( uint256_modinv( uint256_create_from_u32( 2U ), p, &inv ) );
+  ASSERT_SAME( uint256_rshift( uint256_add( p, objs->one ), 1 ), inv );
+
+  // unreduced input, and the largest odd and even moduli
+  ASSERT( uint256_modinv( objs->max, p, &inv ) );
+  ASSERT( is_modinv( objs->max, inv, p ) );
+  ASSERT( uint256_modinv( objs->msb_set, objs->max, &inv ) );
+  ASSERT( is_modinv( objs->msb_set, inv, objs->max ) );
+  ASSERT( uint256_modinv( objs->max, objs->msb_set, &inv ) );
+  ASSERT( is_modinv( objs->max, inv, objs->msb_set ) );
+
+  // equal top bits, so the word-sized approximations compare the
+  // wrong way and a coefficient row has to be negated
+  UInt256 a = uint256_create_from_hex( "400000000000000000000000000000000432a8be5" );
+  UInt256 m = uint256_create_from_hex( "40000000000000000000013a94d68000000000001" );
+  ASSERT( uint256_modinv( a, m, &inv ) );
+  ASSERT( is_modinv( a, inv, m ) );
+
+  // no inverse: result is left alone
+  inv = objs->one;
+  ASSERT( !uint256_modinv( objs->zero, p, &inv ) );
+  ASSERT( !uint256_modinv( p, p, &inv ) );
+  ASSERT( !uint256_modinv( uint256_create_from_u32( 6U ), uint256_create_from_u32( 9U ), &inv ) );
+  ASSERT( !uint256_modinv( uint256_create_from_u32( 6U ), uint256_create_from_u32( 8U ), &inv ) );
+  ASSERT( !uint256_modinv( objs->max, objs->one, &inv ) );
+  ASSERT( !uint256_modinv( objs->max, objs->zero, &inv ) );
+  ASSERT_SAME( objs->one, inv );
+}
+
+void test_modinv_random( TestObjs *objs ) {
+  for ( int iter = 0; iter < 300; ++iter ) {
+    UInt256 val = random_operand(), mod = random_operand(), inv;
+    // alternate odd and even moduli to cover both algorithms
+    if ( iter % 2 == 0 )
+      mod.data[0] |= 1U;
+    else
+      mod.data[0] &= ~1U;
+    if ( uint256_bit_length( mod ) < 2 )
+      continue;
+
+    int coprime = uint256_cmp( uint256_gcd( val, mod ), objs->one ) == 0;
+    inv = objs->zero;
+    ASSERT( coprime == uint256_modinv( val, mod, &inv ) );
+    if ( coprime )
+      ASSERT( is_modinv( val, inv, mod ) );
+  }
+}
+
+// The MULX/ADX kernels must agree with the portable limb code. On a
+// CPU without them both passes take the portable path.
+void test_adx_kernels( TestObjs *objs ) {
+  UInt256MontCtx mont;
+  UInt256BarrettCtx barrett;
+  int have_adx = uint256_use_adx( 1 );
+
+  for ( int iter = 0; iter < 500; ++iter ) {
+    UInt256 a, b, m;
+    // every fourth round uses all-ones limbs to push the carries
+    if ( iter % 4 == 0 ) {
+      a = objs->max;
+      b = iter % 8 == 0 ? objs->max : random_operand();
+      m = objs->max;
+    } else {
+      a = random_operand();
+      b = random_operand();
+      m = random_operand();
+      m.data[0] |= 1U;
+    }
+    if ( !uint256_mont_ctx_init( &mont, m ) || !uint256_barrett_ctx_init( &barrett, m ) )
+      continue;
+    UInt256 am = uint256_mod( a, m ), bm = uint256_mod( b, m );
+
+    UInt256 prod[2], mont_prod[2], barrett_prod[2];
+    UInt512 wide[2];
+    for ( int pass = 0; pass < 2; ++pass ) {
+      ASSERT( uint256_use_adx( pass == 0 ) == (pass == 0 && have_adx) );
+      prod[pass] = uint256_mul( a, b );
+      wide[pass] = uint256_mul_wide( a, b );
+      mont_prod[pass] = uint256_mont_mul( &mont, am, bm );
+      barrett_prod[pass] = uint256_barrett_mul( &barrett, am, bm );
+    }
+    uint256_use_adx( 1 );
+
+    ASSERT_SAME( prod[0], prod[1] );
+    for ( int i = 0; i < 16; ++i )
+      ASSERT( wide[0].data[i] == wide[1].data[i] );
+    ASSERT_SAME( mont_prod[0], mont_prod[1] );
+    ASSERT_SAME( barrett_prod[0], barrett_prod[1] );
+    for ( int i = 0; i < 8; ++i )
+      ASSERT( prod[0].data[i] == wide[0].data[i] );
+    ASSERT_SAME( uint512_mod( uint256_mul_wide( am, bm ), m ), barrett_prod[0] );
+  }
+}
+
+void test_checked_arith( TestObjs *objs ) {
+  UInt256 result, two = uint256_create_from_u32( 2U );
+
+  ASSERT( !uint256_add_carry( objs->max, objs->zero, &result ) );
+  ASSERT_SAME( objs->max, result );
+  ASSERT( uint256_add_carry( objs->max, objs->one, &result ) );
+  ASSERT_SAME( objs->zero, result );
+  ASSERT( uint256_add_carry( objs->msb_set, objs->msb_set, &result ) );
+  ASSERT_SAME( objs->zero, result );
+  ASSERT_SAME( objs->max, uint256_add_sat( objs->max, objs->one ) );
+  ASSERT_SAME( objs->max, uint256_add_sat( objs->msb_set, objs->msb_set ) );
+  ASSERT_SAME( two, uint256_add_sat( objs->one, objs->one ) );
+
+  ASSERT( !uint256_sub_borrow( objs->one, objs->one, &result ) );
+  ASSERT_SAME( objs->zero, result );
+  ASSERT( uint256_sub_borrow( objs->zero, objs->one, &result ) );
+  ASSERT_SAME( objs->max, result );
+  ASSERT_SAME( objs->zero, uint256_sub_sat( objs->zero, objs->one ) );
+  ASSERT_SAME( objs->zero, uint256_sub_sat( objs->one, objs->max ) );
+  ASSERT_SAME( objs->one, uint256_sub_sat( two, objs->one ) );
+
+  ASSERT( !uint256_mul_checked( objs->max, objs->one, &result ) );
+  ASSERT_SAME( objs->max, result );
+  ASSERT( !uint256_mul_checked( objs->zero, objs->max, &result ) );
+  ASSERT_SAME( objs->zero, result );
+  ASSERT( uint256_mul_checked( objs->msb_set, two, &result ) );
+  ASSERT_SAME( objs->zero, result );
+  ASSERT( uint256_mul_checked( objs->max, objs->max, &result ) );
+  ASSERT_SAME( objs->one, result );
+  ASSERT_SAME( objs->max, uint256_mul_sat( objs->msb_set, two ) );
+  ASSERT_SAME( objs->msb_set, uint256_mul_sat( objs->msb_set, objs->one ) );
+
+  // 2^128 * 2^127 fits, 2^128 * 2^128 does not
+  UInt256 p128 = uint256_lshift( objs->one, 128 ), p127 = uint256_lshift( objs->one, 127 );
+  ASSERT( !uint256_mul_checked( p128, p127, &result ) );
+  ASSERT_SAME( objs->msb_set, result );
+  ASSERT( uint256_mul_checked( p128, p128, &result ) );
+  ASSERT_SAME( objs->zero, result );
+}
+
+void test_checked_random( TestObjs *objs ) {
+  for ( int iter = 0; iter < 1000; ++iter ) {
+    UInt256 a = random_operand(), b = random_operand(), result, expected;
+
+    int carry = uint256_add_carry( a, b, &result );
+    ASSERT_SAME( uint256_add( a, b ), result );
+    ASSERT( carry == (uint256_cmp( result, a ) < 0) );
+    expected = carry ? objs->max : result;
+    ASSERT_SAME( expected, uint256_add_sat( a, b ) );
+
+    int borrow = uint256_sub_borrow( a, b, &result );
+    ASSERT_SAME( uint256_sub( a, b ), result );
+    ASSERT( borrow == (uint256_cmp( a, b ) < 0) );
+    expected = borrow ? objs->zero : result;
+    ASSERT_SAME( expected, uint256_sub_sat( a, b ) );
+
+    int overflow = uint256_mul_checked( a, b, &result );
+    ASSERT_SAME( uint256_mul( a, b ), result );
+    ASSERT( overflow == uint256_mul_overflows( a, b ) );
+    expected = overflow ? objs->max : result;
+    ASSERT_SAME( expected, uint256_mul_sat( a, b ) );
+  }
+}
+
+void test_u64_ops( TestObjs *objs ) {
+  UInt256 val;
+
+  ASSERT_SAME( objs->zero, uint256_add_u64( objs->max, 1 ) );
+  ASSERT_SAME( objs->max, uint256_add_u64( objs->max, 0 ) );
+  ASSERT_SAME( from_u64( UINT64_MAX ), uint256_add_u64( objs->zero, UINT64_MAX ) );
+  // the carry runs through two all-ones limbs and stops at the third
+  val = uint256_create_from_hex( "5ffffffffffffffffffffffffffffffff" );
+  ASSERT_SAME( uint256_create_from_hex( "600000000000000000000000000000000" ), uint256_add_u64( val, 1 ) );
+  ASSERT_SAME( uint256_create_from_hex( "600000000000000000000000000000001" ), uint256_add_u64( val, 2 ) );
+
+  ASSERT_SAME( objs->zero, uint256_mul_u64( objs->max, 0 ) );
+  ASSERT_SAME( objs->max, uint256_mul_u64( objs->max, 1 ) );
+  ASSERT_SAME( objs->zero, uint256_mul_u64( objs->msb_set, 2 ) );
+  // (2^256 - 1) * (2^64 - 1) == 1 - 2^64 mod 2^256
+  val = uint256_create_from_hex( "ffffffffffffffffffffffffffffffffffffffffffffffff0000000000000001" );
+  ASSERT_SAME( val, uint256_mul_u64( objs->max, UINT64_MAX ) );
+
+  ASSERT( uint256_cmp_u64( objs->zero, 0 ) == 0 );
+  ASSERT( uint256_cmp_u64( objs->zero, 1 ) < 0 );
+  ASSERT( uint256_cmp_u64( from_u64( UINT64_MAX ), UINT64_MAX ) == 0 );
+  ASSERT( uint256_cmp_u64( from_u64( UINT64_MAX - 1 ), UINT64_MAX ) < 0 );
+  ASSERT( uint256_cmp_u64( objs->msb_set, UINT64_MAX ) > 0 );
+  ASSERT( uint256_cmp_u64( uint256_lshift( objs->one, 64 ), 0 ) > 0 );
+}
+
+void test_u64_random( TestObjs *objs ) {
+  (void) objs;
+  for ( int iter = 0; iter < 1000; ++iter ) {
+    UInt256 a = random_operand();
+    // mostly small words, with the odd full-width one
+    uint64_t w = iter % 4 == 0 ? test_rand() : test_rand() % 1000;
+    UInt256 wide = from_u64( w );
+
+    ASSERT_SAME( uint256_add( a, wide ), uint256_add_u64( a, w ) );
+    ASSERT_SAME( uint256_mul( a, wide ), uint256_mul_u64( a, w ) );
+    int cmp = uint256_cmp( a, wide ), cmp_u64 = uint256_cmp_u64( a, w );
+    ASSERT( (cmp < 0) == (cmp_u64 < 0) && (cmp > 0) == (cmp_u64 > 0) );
+
+    // and operands that fit in a word themselves
+    uint64_t v = test_rand() >> (test_rand() % 64);
+    cmp = uint256_cmp( from_u64( v ), wide );
+    cmp_u64 = uint256_cmp_u64( from_u64( v ), w );
+    ASSERT( (cmp < 0) == (cmp_u64 < 0) && (cmp > 0) == (cmp_u64 > 0) );
+  }
+}
+
+void test_bytes_encode( TestObjs *objs ) {
+  UInt256 vals[2], back[2];
+  uint8_t be[2 * UINT256_BYTES], le[2 * UINT256_BYTES];
+
+  vals[0] = uint256_create_from_hex( "0102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f20" );
+  vals[1] = objs->one;
+  uint256_encode_be( be, vals, 2 );
+  uint256_encode_le( le, vals, 2 );
+  for ( int i = 0; i < UINT256_BYTES; ++i ) {
+    ASSERT( be[i] == i + 1 );
+    ASSERT( le[i] == UINT256_BYTES - i );
+    ASSERT( be[UINT256_BYTES + i] == (i == UINT256_BYTES - 1) );
+    ASSERT( le[UINT256_BYTES + i] == (i == 0) );
+  }
+
+  uint256_decode_be( back, be, 2 );
+  ASSERT_SAME( vals[0], back[0] );
+  ASSERT_SAME( vals[1], back[1] );
+  uint256_decode_le( back, le, 2 );
+  ASSERT_SAME( vals[0], back[0] );
+  ASSERT_SAME( vals[1], back[1] );
+}
+
+void test_bytes_random( TestObjs *objs ) {
+  UInt256 vals[37], back[37];
+  uint8_t buf[37 * UINT256_BYTES + 1];
+  (void) objs;
+
+  for ( unsigned i = 0; i < 37; ++i )
+    vals[i] = random_operand();
+  // every count up to a few SIMD blocks plus a tail, from a
+  // misaligned buffer
+  for ( size_t n = 0; n <= 37; ++n ) {
+    uint256_encode_be( buf + 1, vals, n );
+    for ( size_t i = 0; i < n; ++i ) {
+      uint8_t one[UINT256_BYTES];
+      uint256_encode_be( one, &vals[i], 1 );
+      ASSERT( memcmp( one, buf + 1 + i * UINT256_BYTES, UINT256_BYTES ) == 0 );
+      // the low byte of the value is the last one
+      ASSERT( one[UINT256_BYTES - 1] == (vals[i].data[0] & 0xff) );
+    }
+    uint256_decode_be( back, buf + 1, n );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( vals[i], back[i] );
+
+    uint256_encode_le( buf + 1, vals, n );
+    uint256_decode_le( back, buf + 1, n );
+    for ( size_t i = 0; i < n; ++i )
+      ASSERT_SAME( vals[i], back[i] );
+  }
+}
+
+void test_array_file( TestObjs *objs ) {
+  UInt256 vals[1500];
+  UInt256FileMap fm;
+  char path[] = "/tmp/uint256_testXXXXXX";
+  int fd = mkstemp( path );
+  ASSERT( fd >= 0 );
+  close( fd );
+
+  // more values than one write chunk
+  for ( unsigned i = 0; i < 1500; ++i )
+    vals[i] = random_operand();
+  vals[0] = objs->max;
+
+  ASSERT( uint256_write_file( path, vals, 1500, UINT256_ORDER_LE_LIMBS ) );
+  ASSERT( uint256_map_file( &fm, path ) );
+  ASSERT( fm.count == 1500 );
+  // a little-endian host uses the file in place
+  ASSERT( (fm.copy == NULL) == (fm.map != NULL) );
+  for ( unsigned i = 0; i < 1500; ++i )
+    ASSERT_SAME( vals[i], fm.vals[i] );
+  uint256_unmap_file( &fm );
+  ASSERT( fm.vals == NULL );
+
+  ASSERT( uint256_write_file( path, vals, 1500, UINT256_ORDER_BE_BYTES ) );
+  ASSERT( uint256_map_file( &fm, path ) );
+  ASSERT( fm.count == 1500 );
+  for ( unsigned i = 0; i < 1500; ++i )
+    ASSERT_SAME( vals[i], fm.vals[i] );
+  uint256_unmap_file( &fm );
+
+  ASSERT( uint256_write_file( path, vals, 0, UINT256_ORDER_BE_BYTES ) );
+  ASSERT( uint256_map_file( &fm, path ) );
+  ASSERT( fm.count == 0 );
+  uint256_unmap_file( &fm );
+
+  // a short file, a file with a trailing partial value and a bad
+  // magic number are all rejected
+  FILE *out = fopen( path, "wb" );
+  fputs( "UINT256\n", out );
+  fclose( out );
+  ASSERT( !uint256_map_file( &fm, path ) );
+  ASSERT( fm.vals == NULL );
+
+  ASSERT( uint256_write_file( path, vals, 3, UINT256_ORDER_LE_LIMBS ) );
+  out = fopen( path, "ab" );
+  fputc( 0, out );
+  fclose( out );
+  ASSERT( !uint256_map_file( &fm, path ) );
+
+  ASSERT( uint256_write_file( path, vals, 3, UINT256_ORDER_LE_LIMBS ) );
+  out = fopen( path, "r+b" );
+  fputc( 'X', out );
+  fclose( out );
+  ASSERT( !uint256_map_file( &fm, path ) );
+
+  unlink( path );
+  ASSERT( !uint256_map_file( &fm, path ) );
+}
@@ -0,0 +1,289 @@
+// Checks a stream of arithmetic facts in the format genfact.rb
+// writes, one per line:
+//
+//   <hex> <op> <hex> = <hex>
+//
+// where op is +, - or *. The results are exact, so a sum or product
+// that does not fit in 256 bits (or a negative difference) counts as
+// a mismatch, including when the result has more than 64 significant
+// hex digits. The file is memory-mapped and split into one chunk per
+// thread at line boundaries; lines are parsed in place, so nothing
+// is allocated per line. Prints the location of each mismatch (up
+// to a limit) and the overall throughput.
+//
+// Usage: uint256_verify [-t threads] [-q] file
+// Exit status is 0 if every line checked out, 1 if any line was
+// wrong or malformed, and 2 on usage or I/O errors.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "uint256.h"
+
+// Number of bad lines whose locations are printed; the rest are
+// only counted
+#define MAX_REPORTS 20
+
+// Upper bound on the thread count accepted from -t
+#define MAX_THREADS 256
+
+typedef enum {
+  LINE_OK,
+  LINE_BLANK,
+  LINE_MISMATCH,
+  LINE_MALFORMED,
+} LineResult;
+
+// A bad line, kept so the locations can be printed in file order
+typedef struct {
+  unsigned long line;  // line number within the chunk, from 0
+  const char *text;
+  size_t len;
+  LineResult result;
+} Report;
+
+// One thread's share of the file and what it found there
+typedef struct {
+  const char *begin, *end;
+  unsigned long lines, checked, mismatches, malformed;
+  unsigned nreports;
+  Report reports[MAX_REPORTS];
+} Chunk;
+
+static double ns_now( void ) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static int is_blank( char c ) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Find the next whitespace-separated token in [*pos, end), advancing
+// *pos past it. Returns its length, or 0 if the line has no more.
+static size_t next_token( const char **pos, const char *end, const char **tok ) {
+  const char *p = *pos;
+  while (p < end && is_blank(*p)) {
+    p++;
+  }
+  *tok = p;
+  while (p < end && !is_blank(*p)) {
+    p++;
+  }
+  *pos = p;
+  return (size_t) (p - *tok);
+}
+
+static int parse_operand( const char **pos, const char *end, UInt256 *val ) {
+  const char *tok;
+  size_t len = next_token(pos, end, &tok);
+  return len > 0 && uint256_parse_hex(tok, len, val) == UINT256_OK;
+}
+
+// Check one line (without its newline).
+static LineResult check_line( const char *p, const char *end ) {
+  UInt256 left, right, expected, actual;
+  const char *op, *eq, *res;
+  size_t res_len;
+
+  const char *probe = p, *tok;
+  if (next_token(&probe, end, &tok) == 0) {
+    return LINE_BLANK;
+  }
+  if (!parse_operand(&p, end, &left)
+      || next_token(&p, end, &op) != 1 || (*op != '+' && *op != '-' && *op != '*')
+      || !parse_operand(&p, end, &right)
+      || next_token(&p, end, &eq) != 1 || *eq != '='
+      || (res_len = next_token(&p, end, &res)) == 0
+      || next_token(&p, end, &tok) != 0) {
+    return LINE_MALFORMED;
+  }
+  //an exact result too wide for 256 bits is well-formed, but can't
+  //be what the (wrapping) operation gives
+  UInt256Status status = uint256_parse_hex(res, res_len, &expected);
+  if (status == UINT256_ERR_OVERFLOW) {
+    return LINE_MISMATCH;
+  } else if (status != UINT256_OK) {
+    return LINE_MALFORMED;
+  }
+
+  //the expected values are exact, so wrapping is itself a mismatch
+  switch (*op) {
+  case '+':
+    actual = uint256_add(left, right);
+    if (uint256_cmp(actual, left) < 0) {
+      return LINE_MISMATCH;
+    }
+    break;
+  case '-':
+    if (uint256_cmp(left, right) < 0) {
+      return LINE_MISMATCH;
+    }
+    actual = uint256_sub(left, right);
+    break;
+  case '*':
+    if (uint256_mul_overflows(left, right)) {
+      return LINE_MISMATCH;
+    }
+    actual = uint256_mul(left, right);
+    break;
+  default:
+    return LINE_MALFORMED;
+  }
+  return uint256_cmp(actual, expected) == 0 ? LINE_OK : LINE_MISMATCH;
+}
+
+static void *check_chunk( void *arg ) {
+  Chunk *chunk = arg;
+  const char *p = chunk->begin;
+  while (p < chunk->end) {
+    const char *nl = memchr(p, '\n', (size_t) (chunk->end - p));
+    const char *eol = nl ? nl : chunk->end;
+    LineResult res = check_line(p, eol);
+    if (res != LINE_BLANK) {
+      chunk->checked++;
+    }
+    if (res == LINE_MISMATCH || res == LINE_MALFORMED) {
+      if (res == LINE_MISMATCH) {
+        chunk->mismatches++;
+      } else {
+        chunk->malformed++;
+      }
+      if (chunk->nreports < MAX_REPORTS) {
+        Report *rep = &chunk->reports[chunk->nreports++];
+        rep->line = chunk->lines;
+        rep->text = p;
+        rep->len = (size_t) (eol - p);
+        rep->result = res;
+      }
+    }
+    chunk->lines++;
+    p = eol + 1;
+  }
+  return NULL;
+}
+
+static void usage( const char *prog ) {
+  fprintf(stderr, "usage: %s [-t threads] [-q] file\n", prog);
+  exit(2);
+}
+
+int main( int argc, char **argv ) {
+  long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+  int quiet = 0, opt;
+  while ((opt = getopt(argc, argv, "t:q")) != -1) {
+    if (opt == 't') {
+      nthreads = strtol(optarg, NULL, 10);
+      if (nthreads < 1 || nthreads > MAX_THREADS) {
+        usage(argv[0]);
+      }
+    } else if (opt == 'q') {
+      quiet = 1;
+    } else {
+      usage(argv[0]);
+    }
+  }
+  if (optind != argc - 1) {
+    usage(argv[0]);
+  }
+  //sysconf can fail or report more CPUs than are worth a thread
+  if (nthreads < 1) {
+    nthreads = 1;
+  } else if (nthreads > MAX_THREADS) {
+    nthreads = MAX_THREADS;
+  }
+
+  const char *path = argv[optind];
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    perror(path);
+    return 2;
+  }
+  size_t size = (size_t) st.st_size;
+  const char *data = NULL;
+  if (size > 0) {
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      perror(path);
+      return 2;
+    }
+    madvise((void *) data, size, MADV_SEQUENTIAL);
+  }
+  close(fd);
+
+  //split at line boundaries; a thread whose share falls inside one
+  //long line just gets an empty chunk
+  Chunk *chunks = calloc((size_t) nthreads, sizeof(Chunk));
+  pthread_t *threads = calloc((size_t) nthreads, sizeof(pthread_t));
+  if (!chunks || !threads) {
+    perror("calloc");
+    return 2;
+  }
+  const char *end = data + size, *start = data;
+  for (long i = 0; i < nthreads; i++) {
+    const char *split = end;
+    if (i < nthreads - 1) {
+      split = data + size / nthreads * (i + 1);
+      if (split < start) {
+        split = start;
+      }
+      if (split > data && split[-1] != '\n') {
+        const char *nl = memchr(split, '\n', (size_t) (end - split));
+        split = nl ? nl + 1 : end;
+      }
+    }
+    chunks[i].begin = start;
+    chunks[i].end = split;
+    start = split;
+  }
+
+  double t0 = ns_now();
+  for (long i = 1; i < nthreads; i++) {
+    if (pthread_create(&threads[i], NULL, check_chunk, &chunks[i]) != 0) {
+      perror("pthread_create");
+      return 2;
+    }
+  }
+  check_chunk(&chunks[0]);
+  for (long i = 1; i < nthreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  double ns = ns_now() - t0;
+
+  unsigned long lines = 0, checked = 0, mismatches = 0, malformed = 0;
+  unsigned printed = 0;
+  for (long i = 0; i < nthreads; i++) {
+    const Chunk *chunk = &chunks[i];
+    for (unsigned j = 0; j < chunk->nreports && printed < MAX_REPORTS && !quiet; j++, printed++) {
+      const Report *rep = &chunk->reports[j];
+      printf("%s:%lu: %s: %.*s\n", path, lines + rep->line + 1,
+             rep->result == LINE_MISMATCH ? "mismatch" : "malformed", (int) rep->len, rep->text);
+    }
+    lines += chunk->lines;
+    checked += chunk->checked;
+    mismatches += chunk->mismatches;
+    malformed += chunk->malformed;
+  }
+  if (printed < mismatches + malformed && !quiet) {
+    printf("(%lu more not shown)\n", mismatches + malformed - printed);
+  }
+
+  printf("%lu lines checked, %lu mismatched, %lu malformed\n", checked, mismatches, malformed);
+  printf("%.3f s, %.0f ops/sec on %ld thread%s\n", ns / 1e9, ns > 0 ? checked / (ns / 1e9) : 0.0,
+         nthreads, nthreads == 1 ? "" : "s");
+
+  if (size > 0) {
+    munmap((void *) data, size);
+  }
+  free(chunks);
+  free(threads);
+  return mismatches + malformed > 0;
+}
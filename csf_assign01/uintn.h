@@ -0,0 +1,471 @@
+#ifndef UINTN_H
+#define UINTN_H
+
+// Header-only fixed-width unsigned integers for any multiple of 64
+// bits (UIntN<128>, UIntN<512>, UIntN<1024>, ...), generalizing the
+// C UInt256 API. Values are held as 64-bit limbs, limb 0 least
+// significant, and arithmetic wraps modulo 2^Bits just like the C
+// functions. Everything except the C interop is constexpr, and
+// every limb loop has a compile-time trip count, so at -O2 the
+// loops unroll and small values stay in registers.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "uint256.h"
+
+// Limb count at which multiplication switches from schoolbook to
+// Karatsuba. Run uintn_bench to find the crossover on a given
+// machine, and override with -DUINTN_KARATSUBA_THRESHOLD=n.
+#ifndef UINTN_KARATSUBA_THRESHOLD
+#define UINTN_KARATSUBA_THRESHOLD 32
+#endif
+
+// Loops over a value's limbs unroll completely; the nested loops of
+// the wide multiplies unroll by a fixed factor instead, since fully
+// unrolling a 32x32-limb product overflows the instruction cache.
+#ifdef __GNUC__
+#define UINTN_UNROLL _Pragma("GCC unroll 32")
+#define UINTN_UNROLL_PARTIAL _Pragma("GCC unroll 8")
+#else
+#define UINTN_UNROLL
+#define UINTN_UNROLL_PARTIAL
+#endif
+
+namespace uintn_detail {
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// a + b + carry, updating carry (0 or 1). Written with comparisons
+// rather than intrinsics so it works in constant expressions; GCC
+// still lowers a chain of these to adc.
+constexpr uint64_t addc( uint64_t a, uint64_t b, unsigned &carry ) {
+  uint64_t s = a + b;
+  unsigned c1 = s < a;
+  uint64_t r = s + carry;
+  carry = c1 | (r < s);
+  return r;
+}
+
+// a - b - borrow, updating borrow (0 or 1)
+constexpr uint64_t subb( uint64_t a, uint64_t b, unsigned &borrow ) {
+  uint64_t d = a - b;
+  unsigned b1 = a < b;
+  uint64_t r = d - borrow;
+  borrow = b1 | (d < borrow);
+  return r;
+}
+
+// a*b + t + c as a 128-bit value (cannot overflow), low word
+// returned and high word stored through hi
+constexpr uint64_t mac( uint64_t a, uint64_t b, uint64_t t, uint64_t c, uint64_t &hi ) {
+  uint128_t p = (uint128_t) a * b + t + c;
+  hi = (uint64_t) (p >> 64);
+  return (uint64_t) p;
+}
+
+// Carry-propagating add and borrow-propagating subtract of two
+// n-limb arrays (r may alias either), returning the carry/borrow out.
+constexpr unsigned add_n( uint64_t *r, const uint64_t *a, const uint64_t *b, unsigned n ) {
+  unsigned carry = 0;
+  for (unsigned i = 0; i < n; i++) {
+    r[i] = addc(a[i], b[i], carry);
+  }
+  return carry;
+}
+
+constexpr unsigned sub_n( uint64_t *r, const uint64_t *a, const uint64_t *b, unsigned n ) {
+  unsigned borrow = 0;
+  for (unsigned i = 0; i < n; i++) {
+    r[i] = subb(a[i], b[i], borrow);
+  }
+  return borrow;
+}
+
+// r = |a - b| on n limbs, returning 1 if a < b.
+constexpr unsigned absdiff_n( uint64_t *r, const uint64_t *a, const uint64_t *b, unsigned n ) {
+  for (unsigned i = n; i-- > 0; ) {
+    if (a[i] != b[i]) {
+      if (a[i] < b[i]) {
+        sub_n(r, b, a, n);
+        return 1;
+      }
+      break;
+    }
+  }
+  sub_n(r, a, b, n);
+  return 0;
+}
+
+// Schoolbook products of two N-limb arrays: the full 2N-limb
+// product, and the low N limbs only.
+template<unsigned N>
+constexpr void mul_full_schoolbook( uint64_t *r, const uint64_t *a, const uint64_t *b ) {
+  for (unsigned i = 0; i < 2 * N; i++) {
+    r[i] = 0;
+  }
+  UINTN_UNROLL_PARTIAL
+  for (unsigned i = 0; i < N; i++) {
+    uint64_t carry = 0;
+    UINTN_UNROLL_PARTIAL
+    for (unsigned j = 0; j < N; j++) {
+      r[i + j] = mac(a[j], b[i], r[i + j], carry, carry);
+    }
+    r[i + N] = carry;
+  }
+}
+
+template<unsigned N>
+constexpr void mul_lo_schoolbook( uint64_t *r, const uint64_t *a, const uint64_t *b ) {
+  for (unsigned i = 0; i < N; i++) {
+    r[i] = 0;
+  }
+  UINTN_UNROLL_PARTIAL
+  for (unsigned i = 0; i < N; i++) {
+    uint64_t carry = 0;
+    UINTN_UNROLL_PARTIAL
+    for (unsigned j = 0; i + j < N; j++) {
+      r[i + j] = mac(a[j], b[i], r[i + j], carry, carry);
+    }
+  }
+}
+
+template<unsigned N>
+constexpr void mul_full( uint64_t *r, const uint64_t *a, const uint64_t *b );
+
+// One level of Karatsuba on N (even) limbs, with mul_full choosing
+// the method for the three half-size products. Uses the subtractive
+// form, a0*b1 + a1*b0 = a0*b0 + a1*b1 - (a0 - a1)*(b0 - b1), so the
+// middle product stays at H limbs instead of growing a carry limb.
+template<unsigned N>
+constexpr void mul_full_karatsuba( uint64_t *r, const uint64_t *a, const uint64_t *b ) {
+  static_assert(N % 2 == 0, "Karatsuba split needs an even limb count");
+  constexpr unsigned H = N / 2;
+  uint64_t da[H] = {}, db[H] = {}, m[N] = {}, mid[N + 1] = {};
+
+  //a0*b0 and a1*b1 go straight into the low and high halves of r
+  mul_full<H>(r, a, b);
+  mul_full<H>(r + N, a + H, b + H);
+
+  unsigned neg = absdiff_n(da, a, a + H, H) ^ absdiff_n(db, b, b + H, H);
+  mul_full<H>(m, da, db);
+  mid[N] = add_n(mid, r, r + N, N);
+  if (neg) {
+    mid[N] += add_n(mid, mid, m, N);
+  } else {
+    mid[N] -= sub_n(mid, mid, m, N);
+  }
+
+  //the middle term is less than 2^(64N + 1), so the carry out of
+  //its top limb stops inside r
+  unsigned carry = add_n(r + H, r + H, mid, N + 1);
+  for (unsigned i = H + N + 1; i < 2 * N; i++) {
+    r[i] = addc(r[i], 0, carry);
+  }
+}
+
+// Full product, switching to Karatsuba at UINTN_KARATSUBA_THRESHOLD
+// limbs (uintn_bench reports the crossover on the host machine).
+template<unsigned N>
+constexpr void mul_full( uint64_t *r, const uint64_t *a, const uint64_t *b ) {
+  if constexpr (N >= UINTN_KARATSUBA_THRESHOLD && N % 2 == 0) {
+    mul_full_karatsuba<N>(r, a, b);
+  } else {
+    mul_full_schoolbook<N>(r, a, b);
+  }
+}
+
+// Low N limbs of the product. Above the threshold this is a full
+// Karatsuba product of the low halves plus two half-size truncated
+// cross products, about half the work of a full product.
+template<unsigned N>
+constexpr void mul_lo( uint64_t *r, const uint64_t *a, const uint64_t *b ) {
+  if constexpr (N >= UINTN_KARATSUBA_THRESHOLD && N % 2 == 0) {
+    constexpr unsigned H = N / 2;
+    uint64_t t1[H] = {}, t2[H] = {};
+    mul_full<H>(r, a, b);
+    mul_lo<H>(t1, a, b + H);
+    mul_lo<H>(t2, a + H, b);
+    add_n(t1, t1, t2, H);
+    add_n(r + H, r + H, t1, H);
+  } else {
+    mul_lo_schoolbook<N>(r, a, b);
+  }
+}
+
+constexpr int hex_value( char c ) {
+  return c >= '0' && c <= '9' ? c - '0'
+       : c >= 'a' && c <= 'f' ? c - 'a' + 10
+       : c >= 'A' && c <= 'F' ? c - 'A' + 10
+       : -1;
+}
+
+}
+
+template<unsigned Bits>
+class UIntN {
+  static_assert(Bits > 0 && Bits % 64 == 0, "UIntN width must be a positive multiple of 64");
+
+public:
+  static constexpr unsigned LIMBS = Bits / 64;
+
+  // Zero, or a single-limb value.
+  constexpr UIntN() : m_limbs{} {}
+  constexpr UIntN( uint64_t val ) : m_limbs{val} {}
+
+  // Zero-extend or truncate a value of another width.
+  template<unsigned Other>
+  constexpr explicit UIntN( const UIntN<Other> &other ) : m_limbs{} {
+    constexpr unsigned n = LIMBS < UIntN<Other>::LIMBS ? LIMBS : UIntN<Other>::LIMBS;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < n; i++) {
+      m_limbs[i] = other.limb(i);
+    }
+  }
+
+  // Create a value from hex digits (no prefix). As with
+  // uint256_create_from_hex, digits are read up to the first
+  // character that is not a hex digit, and only the rightmost Bits/4
+  // of them are used.
+  static constexpr UIntN from_hex( const char *hex ) {
+    UIntN result;
+    size_t len = 0;
+    while (uintn_detail::hex_value(hex[len]) >= 0) {
+      len++;
+    }
+    for (unsigned digit = 0; digit < LIMBS * 16 && digit < len; digit++) {
+      int v = uintn_detail::hex_value(hex[len - 1 - digit]);
+      result.m_limbs[digit / 16] |= (uint64_t) v << (4 * (digit % 16));
+    }
+    return result;
+  }
+
+  // Interop with the C struct: zero-extends or truncates to/from 256
+  // bits. The word order matches the limb order on little-endian
+  // targets, so this is a plain copy there.
+  explicit UIntN( const UInt256 &val ) : m_limbs{} {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(m_limbs, val.data, LIMBS < 4 ? sizeof(m_limbs) : sizeof(val.data));
+#else
+    for (unsigned i = 0; i < LIMBS && i < 4; i++) {
+      m_limbs[i] = (uint64_t) val.data[2*i] | ((uint64_t) val.data[2*i + 1] << 32);
+    }
+#endif
+  }
+
+  UInt256 to_uint256() const {
+    UInt256 result = {};
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    std::memcpy(result.data, m_limbs, LIMBS < 4 ? sizeof(m_limbs) : sizeof(result.data));
+#else
+    for (unsigned i = 0; i < LIMBS && i < 4; i++) {
+      result.data[2*i] = (uint32_t) m_limbs[i];
+      result.data[2*i + 1] = (uint32_t) (m_limbs[i] >> 32);
+    }
+#endif
+    return result;
+  }
+
+  constexpr uint64_t limb( unsigned i ) const { return m_limbs[i]; }
+  constexpr void set_limb( unsigned i, uint64_t val ) { m_limbs[i] = val; }
+
+  // The LIMBS limbs, least significant first.
+  constexpr const uint64_t *limbs() const { return m_limbs; }
+  constexpr uint64_t *limbs() { return m_limbs; }
+
+  constexpr bool is_bit_set( unsigned index ) const {
+    return index < Bits && ((m_limbs[index / 64] >> (index % 64)) & 1);
+  }
+
+  // Number of significant bits (0 for zero).
+  constexpr unsigned bit_length() const {
+    for (unsigned i = LIMBS; i > 0; i--) {
+      uint64_t w = m_limbs[i - 1];
+      if (w != 0) {
+        unsigned bits = 64;
+        while (!(w >> 63)) {
+          w <<= 1;
+          bits--;
+        }
+        return (i - 1) * 64 + bits;
+      }
+    }
+    return 0;
+  }
+
+  constexpr explicit operator bool() const {
+    uint64_t any = 0;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      any |= m_limbs[i];
+    }
+    return any != 0;
+  }
+
+  constexpr UIntN &operator+=( const UIntN &rhs ) {
+    unsigned carry = 0;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      m_limbs[i] = uintn_detail::addc(m_limbs[i], rhs.m_limbs[i], carry);
+    }
+    return *this;
+  }
+
+  constexpr UIntN &operator-=( const UIntN &rhs ) {
+    unsigned borrow = 0;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      m_limbs[i] = uintn_detail::subb(m_limbs[i], rhs.m_limbs[i], borrow);
+    }
+    return *this;
+  }
+
+  // Truncated product: only the partial products that land in the
+  // low LIMBS limbs are computed.
+  constexpr UIntN &operator*=( const UIntN &rhs ) {
+    UIntN product;
+    uintn_detail::mul_lo<LIMBS>(product.m_limbs, m_limbs, rhs.m_limbs);
+    return *this = product;
+  }
+
+  constexpr UIntN &operator&=( const UIntN &rhs ) {
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      m_limbs[i] &= rhs.m_limbs[i];
+    }
+    return *this;
+  }
+
+  constexpr UIntN &operator|=( const UIntN &rhs ) {
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      m_limbs[i] |= rhs.m_limbs[i];
+    }
+    return *this;
+  }
+
+  constexpr UIntN &operator^=( const UIntN &rhs ) {
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      m_limbs[i] ^= rhs.m_limbs[i];
+    }
+    return *this;
+  }
+
+  // Shifts by Bits or more give zero. Whole limbs move first, then
+  // one funnel shift joins each pair (the >> 1 >> (63 - bs) split
+  // keeps bs == 0 well-defined).
+  constexpr UIntN &operator<<=( unsigned shift ) {
+    unsigned ls = shift / 64, bs = shift % 64;
+    UINTN_UNROLL
+    for (unsigned k = 0; k < LIMBS; k++) {
+      unsigned i = LIMBS - 1 - k;
+      uint64_t hi = i >= ls ? m_limbs[i - ls] : 0;
+      uint64_t lo = i >= ls + 1 ? m_limbs[i - ls - 1] : 0;
+      m_limbs[i] = (hi << bs) | ((lo >> 1) >> (63 - bs));
+    }
+    return *this;
+  }
+
+  constexpr UIntN &operator>>=( unsigned shift ) {
+    unsigned ls = shift / 64, bs = shift % 64;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      uint64_t lo = i + ls < LIMBS ? m_limbs[i + ls] : 0;
+      uint64_t hi = i + ls + 1 < LIMBS ? m_limbs[i + ls + 1] : 0;
+      m_limbs[i] = (lo >> bs) | ((hi << 1) << (63 - bs));
+    }
+    return *this;
+  }
+
+  constexpr UIntN operator~() const {
+    UIntN result;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      result.m_limbs[i] = ~m_limbs[i];
+    }
+    return result;
+  }
+
+  constexpr UIntN operator-() const {
+    return UIntN() - *this;
+  }
+
+  friend constexpr UIntN operator+( UIntN lhs, const UIntN &rhs ) { return lhs += rhs; }
+  friend constexpr UIntN operator-( UIntN lhs, const UIntN &rhs ) { return lhs -= rhs; }
+  friend constexpr UIntN operator*( UIntN lhs, const UIntN &rhs ) { return lhs *= rhs; }
+  friend constexpr UIntN operator&( UIntN lhs, const UIntN &rhs ) { return lhs &= rhs; }
+  friend constexpr UIntN operator|( UIntN lhs, const UIntN &rhs ) { return lhs |= rhs; }
+  friend constexpr UIntN operator^( UIntN lhs, const UIntN &rhs ) { return lhs ^= rhs; }
+  friend constexpr UIntN operator<<( UIntN lhs, unsigned shift ) { return lhs <<= shift; }
+  friend constexpr UIntN operator>>( UIntN lhs, unsigned shift ) { return lhs >>= shift; }
+
+  // Negative, zero or positive as lhs is less than, equal to or
+  // greater than rhs, like uint256_cmp.
+  friend constexpr int compare( const UIntN &lhs, const UIntN &rhs ) {
+    for (unsigned i = LIMBS; i-- > 0; ) {
+      if (lhs.m_limbs[i] != rhs.m_limbs[i]) {
+        return lhs.m_limbs[i] < rhs.m_limbs[i] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  friend constexpr bool operator==( const UIntN &lhs, const UIntN &rhs ) {
+    uint64_t diff = 0;
+    UINTN_UNROLL
+    for (unsigned i = 0; i < LIMBS; i++) {
+      diff |= lhs.m_limbs[i] ^ rhs.m_limbs[i];
+    }
+    return diff == 0;
+  }
+
+  friend constexpr bool operator!=( const UIntN &lhs, const UIntN &rhs ) { return !(lhs == rhs); }
+  friend constexpr bool operator<( const UIntN &lhs, const UIntN &rhs ) { return compare(lhs, rhs) < 0; }
+  friend constexpr bool operator<=( const UIntN &lhs, const UIntN &rhs ) { return compare(lhs, rhs) <= 0; }
+  friend constexpr bool operator>( const UIntN &lhs, const UIntN &rhs ) { return compare(lhs, rhs) > 0; }
+  friend constexpr bool operator>=( const UIntN &lhs, const UIntN &rhs ) { return compare(lhs, rhs) >= 0; }
+
+  // Divide by a single nonzero limb, returning the quotient and
+  // storing the remainder through rem (if non-null).
+  constexpr UIntN divmod_u64( uint64_t den, uint64_t *rem = nullptr ) const {
+    UIntN quotient;
+    uint64_t r = 0;
+    for (unsigned i = LIMBS; i-- > 0; ) {
+      uintn_detail::uint128_t num = ((uintn_detail::uint128_t) r << 64) | m_limbs[i];
+      quotient.m_limbs[i] = (uint64_t) (num / den);
+      r = (uint64_t) (num % den);
+    }
+    if (rem) {
+      *rem = r;
+    }
+    return quotient;
+  }
+
+private:
+  uint64_t m_limbs[LIMBS];
+};
+
+// Full product of an A-bit and a B-bit value, as an (A+B)-bit value
+// (never truncates). Equal widths go through Karatsuba above the
+// threshold.
+template<unsigned A, unsigned B>
+constexpr UIntN<A + B> mul_wide( const UIntN<A> &lhs, const UIntN<B> &rhs ) {
+  UIntN<A + B> product;
+  if constexpr (A == B) {
+    uintn_detail::mul_full<UIntN<A>::LIMBS>(product.limbs(), lhs.limbs(), rhs.limbs());
+    return product;
+  }
+  UINTN_UNROLL
+  for (unsigned i = 0; i < UIntN<B>::LIMBS; i++) {
+    uint64_t carry = 0;
+    UINTN_UNROLL
+    for (unsigned j = 0; j < UIntN<A>::LIMBS; j++) {
+      product.set_limb(i + j, uintn_detail::mac(lhs.limb(j), rhs.limb(i), product.limb(i + j), carry, carry));
+    }
+    product.set_limb(i + UIntN<A>::LIMBS, carry);
+  }
+  return product;
+}
+
+#endif // UINTN_H
@@ -0,0 +1,144 @@
+// Finds the schoolbook/Karatsuba crossover for UIntN multiplication
+// on the host machine. For each size it times a full schoolbook
+// product against one level of Karatsuba over schoolbook halves
+// (the threshold is raised out of the way below so the halves never
+// recurse), which is the comparison UINTN_KARATSUBA_THRESHOLD
+// decides. It then times factorials through the product tree in
+// uintn_product.h against folding the factors in one at a time
+// (with the raised threshold, the tree's joins are all schoolbook
+// here, so that comparison shows what the balancing alone buys).
+
+#define UINTN_KARATSUBA_THRESHOLD 0x10000
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "uintn.h"
+#include "uintn_product.h"
+
+// Number of distinct operands cycled through by each benchmark
+#define NVALS 64
+
+static volatile uint64_t sink;
+
+// xorshift64*, fixed seed so runs are comparable
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+static uint64_t rng_next() {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static double ns_now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef void (*MulFn)( uint64_t *r, const uint64_t *a, const uint64_t *b );
+
+// ns per product, best of a few runs to damp scheduler noise
+template<unsigned N>
+static double time_mul( MulFn fn, unsigned reps ) {
+  static uint64_t a[NVALS][N], b[NVALS][N], r[2 * N];
+  for (int i = 0; i < NVALS; i++) {
+    for (unsigned j = 0; j < N; j++) {
+      a[i][j] = rng_next();
+      b[i][j] = rng_next();
+    }
+  }
+  double best = 0;
+  for (int run = 0; run < 15; run++) {
+    double t0 = ns_now();
+    for (unsigned rep = 0; rep < reps; rep++) {
+      for (int i = 0; i < NVALS; i++) {
+        fn(r, a[i], b[i]);
+        sink ^= r[N];
+      }
+    }
+    double ns = (ns_now() - t0) / ((double) reps * NVALS);
+    if (run == 0 || ns < best) {
+      best = ns;
+    }
+  }
+  return best;
+}
+
+// Time one size, returning 1 if Karatsuba won
+template<unsigned N>
+static int compare_size( unsigned reps ) {
+  double school = time_mul<N>(uintn_detail::mul_full_schoolbook<N>, reps);
+  double kara = time_mul<N>(uintn_detail::mul_full_karatsuba<N>, reps);
+  printf("%5u bits %4u limbs %12.2f ns %12.2f ns %8.2fx\n", N * 64, N, school, kara, school / kara);
+  return kara < school;
+}
+
+// us per n!, best of a few runs
+template<unsigned Bits, class Fn>
+static double time_factorial( Fn fn ) {
+  double best = 0;
+  for (int run = 0; run < 5; run++) {
+    double t0 = ns_now();
+    sink ^= fn().value.limb(0);
+    double us = (ns_now() - t0) / 1e3;
+    if (run == 0 || us < best) {
+      best = us;
+    }
+  }
+  return best;
+}
+
+// n! in Bits bits: the single-row fold a leaf uses, run over every
+// factor, against the tree on one thread and on the whole pool
+template<unsigned Bits>
+static void compare_factorial( uint64_t n, UIntNThreadPool &one, UIntNThreadPool &all ) {
+  double fold = time_factorial<Bits>([n] {
+    return uintn_detail::product_leaf<Bits>([]( size_t i ) { return (uint64_t) i + 2; }, 0, n - 1);
+  });
+  double tree1 = time_factorial<Bits>([&] { return uintn_factorial<Bits>(n, one); });
+  double tree = time_factorial<Bits>([&] { return uintn_factorial<Bits>(n, all); });
+  printf("%7llu! %6u bits %12.1f us %12.1f us %12.1f us\n", (unsigned long long) n, Bits, fold, tree1, tree);
+}
+
+int main( int argc, char **argv ) {
+  unsigned reps = 200;
+  if (argc > 1) {
+    reps = (unsigned) strtoul(argv[1], NULL, 10);
+  }
+
+  printf("%-21s %15s %15s %9s\n", "size", "schoolbook", "karatsuba", "speedup");
+  int wins[] = {
+    compare_size<2>(reps * 16),
+    compare_size<4>(reps * 16),
+    compare_size<6>(reps * 8),
+    compare_size<8>(reps * 8),
+    compare_size<12>(reps * 4),
+    compare_size<16>(reps * 4),
+    compare_size<24>(reps * 2),
+    compare_size<32>(reps * 2),
+    compare_size<48>(reps),
+    compare_size<64>(reps),
+  };
+  unsigned sizes[] = { 2, 4, 6, 8, 12, 16, 24, 32, 48, 64 };
+  int n = sizeof(sizes) / sizeof(sizes[0]);
+
+  //the crossover is the smallest size from which Karatsuba keeps winning
+  int cross = n;
+  while (cross > 0 && wins[cross - 1]) {
+    cross--;
+  }
+  if (cross < n) {
+    printf("crossover: %u limbs (build with -DUINTN_KARATSUBA_THRESHOLD=%u)\n", sizes[cross], sizes[cross]);
+  } else {
+    printf("crossover: above %u limbs\n", sizes[n - 1]);
+  }
+
+  UIntNThreadPool one(1), all;
+  printf("\n%-21s %15s %15s %12s(%u)\n", "factorial", "fold", "tree(1)", "tree", all.size());
+  compare_factorial<1024>(100, one, all);
+  compare_factorial<8704>(1000, one, all);
+  compare_factorial<65536>(5000, one, all);
+  compare_factorial<131072>(10000, one, all);
+  return 0;
+}
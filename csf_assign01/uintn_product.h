@@ -0,0 +1,298 @@
+#ifndef UINTN_PRODUCT_H
+#define UINTN_PRODUCT_H
+
+// Products of many word-sized factors (factorials, ranges, lists)
+// as UIntN values. The factors are split into equal runs whose
+// products (the leaves) are computed in parallel on a thread pool,
+// and the leaves are then multiplied together pairwise, level by
+// level, so each multiply sees two operands of about the same size;
+// once those fill half the width, the Karatsuba product takes over.
+// Folding the factors in one at a time instead would spend most of
+// its work multiplying a huge running product by a single word.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "uintn.h"
+
+// A fixed set of worker threads running fork-join loops. The
+// calling thread takes part in each loop, so a pool of size 1 has
+// no workers and runs everything inline. Any number of threads may
+// share a pool: their loops take turns, one at a time.
+class UIntNThreadPool {
+public:
+  // threads == 0 uses one thread per hardware thread.
+  explicit UIntNThreadPool( unsigned threads = 0 ) {
+    if (threads == 0) {
+      threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threads; i++) {
+      m_workers.emplace_back([this] { work(); });
+    }
+  }
+
+  ~UIntNThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &t : m_workers) {
+      t.join();
+    }
+  }
+
+  UIntNThreadPool( const UIntNThreadPool & ) = delete;
+  UIntNThreadPool &operator=( const UIntNThreadPool & ) = delete;
+
+  unsigned size() const { return (unsigned) m_workers.size() + 1; }
+
+  // Run fn(i) for 0 <= i < n across the pool, returning once every
+  // call has finished. Calls for different i may run concurrently;
+  // fn must not throw or start another loop on the same pool (that
+  // would deadlock). A loop started while another thread's loop is
+  // running waits for it to finish.
+  void parallel_for( size_t n, const std::function<void( size_t )> &fn ) {
+    if (m_workers.empty() || n <= 1) {
+      for (size_t i = 0; i < n; i++) {
+        fn(i);
+      }
+      return;
+    }
+    //one loop at a time owns the job fields below
+    std::lock_guard<std::mutex> run(m_run_mutex);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_job = &fn;
+      m_count = n;
+      m_next = 0;
+      m_active = (unsigned) m_workers.size();
+      m_generation++;
+    }
+    m_wake.notify_all();
+    run_tasks();
+    //every worker checks in for every loop, so none can still be
+    //looking at m_job once this returns
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_active == 0; });
+    m_job = nullptr;
+  }
+
+private:
+  void run_tasks() {
+    size_t i;
+    while ((i = m_next.fetch_add(1)) < m_count) {
+      (*m_job)(i);
+    }
+  }
+
+  void work() {
+    uint64_t seen = 0;
+    for (;;) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+        if (m_stop) {
+          return;
+        }
+        seen = m_generation;
+      }
+      run_tasks();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_active == 0) {
+        m_done.notify_one();
+      }
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_run_mutex, m_mutex;
+  std::condition_variable m_wake, m_done;
+  const std::function<void( size_t )> *m_job = nullptr;
+  std::atomic<size_t> m_next{0};
+  size_t m_count = 0;
+  unsigned m_active = 0;
+  uint64_t m_generation = 0;
+  bool m_stop = false;
+};
+
+// Result of a product: the value modulo 2^Bits, whether that is the
+// exact product, and the product modulo 2^256 (what folding the
+// factors with uint256_mul gives), which stays correct when the
+// exact product doesn't fit.
+template<unsigned Bits>
+struct UIntNProduct {
+  UIntN<Bits> value;
+  bool exact;
+  UInt256 low;
+};
+
+namespace uintn_detail {
+
+// Number of limbs up to and including the most significant nonzero
+// one.
+template<unsigned Bits>
+unsigned used_limbs( const UIntN<Bits> &val ) {
+  unsigned n = UIntN<Bits>::LIMBS;
+  while (n > 0 && val.limb(n - 1) == 0) {
+    n--;
+  }
+  return n;
+}
+
+// A partial product and whether it is still exact
+template<unsigned Bits>
+struct ProductNode {
+  UIntN<Bits> value;
+  bool exact;
+};
+
+// Product of factor(i) for begin <= i < end, one single-limb row per
+// factor over just the limbs in use so far.
+template<unsigned Bits, class Factor>
+ProductNode<Bits> product_leaf( const Factor &factor, size_t begin, size_t end ) {
+  constexpr unsigned N = UIntN<Bits>::LIMBS;
+  ProductNode<Bits> node = {UIntN<Bits>(1), true};
+  uint64_t *w = node.value.limbs();
+  unsigned used = 1;
+  for (size_t i = begin; i < end; i++) {
+    uint64_t f = factor(i), carry = 0;
+    if (f == 0) {
+      //exactly zero, however far the product had overflowed
+      node.exact = true;
+    }
+    for (unsigned j = 0; j < used; j++) {
+      w[j] = mac(w[j], f, 0, carry, carry);
+    }
+    if (carry != 0) {
+      if (used < N) {
+        w[used++] = carry;
+      } else {
+        node.exact = false;
+      }
+    }
+  }
+  return node;
+}
+
+// Product of two partial products. Operands that both fill at least
+// half the width go through the Karatsuba multiply; smaller ones are
+// multiplied over their used limbs only. Either way the bits above
+// Bits are only checked for being zero.
+template<unsigned Bits>
+ProductNode<Bits> product_join( const ProductNode<Bits> &a, const ProductNode<Bits> &b ) {
+  constexpr unsigned N = UIntN<Bits>::LIMBS;
+  ProductNode<Bits> node = {UIntN<Bits>(), a.exact && b.exact};
+  unsigned na = used_limbs(a.value), nb = used_limbs(b.value);
+  if ((na == 0 && a.exact) || (nb == 0 && b.exact)) {
+    //a true zero is exact whatever the other side did
+    node.exact = true;
+    return node;
+  }
+  if (na == 0 || nb == 0) {
+    //a multiple of 2^Bits times anything is one too
+    return node;
+  }
+  uint64_t high = 0;
+  if (N >= UINTN_KARATSUBA_THRESHOLD && std::min(na, nb) >= N / 2) {
+    UIntN<2 * Bits> p = mul_wide(a.value, b.value);
+    node.value = UIntN<Bits>(p);
+    for (unsigned i = N; i < 2 * N; i++) {
+      high |= p.limb(i);
+    }
+  } else {
+    std::vector<uint64_t> p(na + nb, 0);
+    for (unsigned i = 0; i < nb; i++) {
+      uint64_t carry = 0;
+      for (unsigned j = 0; j < na; j++) {
+        p[i + j] = mac(a.value.limb(j), b.value.limb(i), p[i + j], carry, carry);
+      }
+      p[i + na] = carry;
+    }
+    for (unsigned i = 0; i < na + nb; i++) {
+      if (i < N) {
+        node.value.set_limb(i, p[i]);
+      } else {
+        high |= p[i];
+      }
+    }
+  }
+  node.exact = node.exact && high == 0;
+  return node;
+}
+
+// Product tree over factor(0) ... factor(n - 1).
+template<unsigned Bits, class Factor>
+UIntNProduct<Bits> product_tree( const Factor &factor, size_t n, UIntNThreadPool &pool ) {
+  static_assert(Bits >= 256, "the product is also reported modulo 2^256");
+  //a few leaves per thread, so uneven leaves still balance out
+  size_t leaves = std::min<size_t>(n, (size_t) pool.size() * 4);
+  leaves = std::max<size_t>(leaves, 1);
+  std::vector<ProductNode<Bits>> level(leaves);
+  pool.parallel_for(leaves, [&]( size_t i ) {
+    level[i] = product_leaf<Bits>(factor, n * i / leaves, n * (i + 1) / leaves);
+  });
+
+  while (level.size() > 1) {
+    //an odd node out moves up a level unchanged
+    std::vector<ProductNode<Bits>> next((level.size() + 1) / 2);
+    pool.parallel_for(level.size() / 2, [&]( size_t i ) {
+      next[i] = product_join(level[2 * i], level[2 * i + 1]);
+    });
+    if (level.size() % 2) {
+      next.back() = level.back();
+    }
+    level.swap(next);
+  }
+  return {level[0].value, level[0].exact, level[0].value.to_uint256()};
+}
+
+// Shared pool for the calls that don't pass one
+inline UIntNThreadPool &default_pool() {
+  static UIntNThreadPool pool;
+  return pool;
+}
+
+}
+
+// Product of the n factors in factors (1 for n == 0).
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_product( const uint64_t *factors, size_t n, UIntNThreadPool &pool ) {
+  return uintn_detail::product_tree<Bits>([factors]( size_t i ) { return factors[i]; }, n, pool);
+}
+
+// Product of lo, lo + 1, ..., hi (1 if lo > hi).
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_range_product( uint64_t lo, uint64_t hi, UIntNThreadPool &pool ) {
+  size_t n = lo > hi ? 0 : (size_t) (hi - lo) + 1;
+  return uintn_detail::product_tree<Bits>([lo]( size_t i ) { return lo + i; }, n, pool);
+}
+
+// n! (the factor 1 is skipped).
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_factorial( uint64_t n, UIntNThreadPool &pool ) {
+  return uintn_range_product<Bits>(2, n, pool);
+}
+
+// The same, on a shared pool with one thread per hardware thread.
+// Concurrent calls are safe, but take turns on the pool.
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_product( const uint64_t *factors, size_t n ) {
+  return uintn_product<Bits>(factors, n, uintn_detail::default_pool());
+}
+
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_range_product( uint64_t lo, uint64_t hi ) {
+  return uintn_range_product<Bits>(lo, hi, uintn_detail::default_pool());
+}
+
+template<unsigned Bits>
+UIntNProduct<Bits> uintn_factorial( uint64_t n ) {
+  return uintn_factorial<Bits>(n, uintn_detail::default_pool());
+}
+
+#endif // UINTN_PRODUCT_H
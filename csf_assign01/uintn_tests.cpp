@@ -0,0 +1,483 @@
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include "tctest.h"
+
+#include "uint256.h"
+#include "uintn.h"
+#include "uintn_product.h"
+
+typedef UIntN<128> U128;
+typedef UIntN<256> U256;
+typedef UIntN<512> U512;
+typedef UIntN<1024> U1024;
+typedef UIntN<2048> U2048;
+typedef UIntN<4096> U4096;
+typedef UIntN<8192> U8192;
+
+struct TestObjs {
+  U256 zero;    // the value equal to 0
+  U256 one;     // the value equal to 1
+  U256 max;     // the value equal to (2^256)-1
+  U256 msb_set; // the value equal to 2^255
+};
+
+// Helper functions for implementing tests
+uint64_t test_rand();
+template<unsigned Bits> UIntN<Bits> random_operand();
+
+#define ASSERT_SAME( expected, actual ) \
+do { \
+  for ( unsigned i_ = 0; i_ < 8; ++i_ ) \
+    ASSERT( (expected).data[i_] == (actual).data[i_] ); \
+} while ( 0 )
+
+// Functions to create and cleanup the test fixture object
+TestObjs *setup();
+void cleanup( TestObjs *objs );
+
+// Compile-time checks: everything below is evaluated by the compiler
+constexpr U256 k_max = ~U256();
+constexpr U256 k_p = U256::from_hex( "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffed" );
+static_assert( k_max + U256( 1 ) == U256(), "add wraps" );
+static_assert( U256() - U256( 1 ) == k_max, "sub wraps" );
+static_assert( k_max * k_max == U256( 1 ), "(2^256-1)^2 mod 2^256 == 1" );
+static_assert( (U256( 1 ) << 255) + (U256( 1 ) << 255) == U256(), "shift and add" );
+static_assert( (k_p >> 252) == U256( 7 ), "rshift" );
+static_assert( k_p.bit_length() == 255, "bit_length" );
+static_assert( U128::from_hex( "ffffffffffffffffffffffffffffffff" ) == ~U128(), "from_hex" );
+static_assert( U128::from_hex( "1234\n" ) == U128( 0x1234 ), "from_hex stops at a non-digit" );
+static_assert( mul_wide( ~U128(), ~U128() ) == U256::from_hex( "fffffffffffffffffffffffffffffffe00000000000000000000000000000001" ), "mul_wide" );
+static_assert( U256( 1000 ).divmod_u64( 7 ) == U256( 142 ), "divmod_u64" );
+static_assert( U512( k_max ).limb( 4 ) == 0 && U128( k_p ).limb( 1 ) == ~0ULL, "width conversions" );
+
+// Test functions
+void test_constexpr( TestObjs *objs );
+void test_interop( TestObjs *objs );
+void test_add_sub( TestObjs *objs );
+void test_mul( TestObjs *objs );
+void test_shifts_bitwise( TestObjs *objs );
+void test_compare( TestObjs *objs );
+void test_from_hex( TestObjs *objs );
+void test_match_c_random( TestObjs *objs );
+void test_mul_wide_random( TestObjs *objs );
+void test_wide_identities( TestObjs *objs );
+void test_karatsuba_small( TestObjs *objs );
+void test_karatsuba_wide( TestObjs *objs );
+void test_factorial( TestObjs *objs );
+void test_product_random( TestObjs *objs );
+void test_product_concurrent( TestObjs *objs );
+
+int main( int argc, char **argv ) {
+  if ( argc > 1 )
+    tctest_testname_to_execute = argv[1];
+
+  TEST_INIT();
+
+  TEST( test_constexpr );
+  TEST( test_interop );
+  TEST( test_add_sub );
+  TEST( test_mul );
+  TEST( test_shifts_bitwise );
+  TEST( test_compare );
+  TEST( test_from_hex );
+  TEST( test_match_c_random );
+  TEST( test_mul_wide_random );
+  TEST( test_wide_identities );
+  TEST( test_karatsuba_small );
+  TEST( test_karatsuba_wide );
+  TEST( test_factorial );
+  TEST( test_product_random );
+  TEST( test_product_concurrent );
+
+  TEST_FINI();
+}
+
+// Deterministic xorshift64 generator for the randomized tests
+uint64_t test_rand() {
+  static uint64_t state = 0x2545f4914f6cdd1dULL;
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// A random value with a random number of significant bits, so
+// short and full-width operands both get exercised
+template<unsigned Bits>
+UIntN<Bits> random_operand() {
+  UIntN<Bits> val;
+  for ( unsigned i = 0; i < UIntN<Bits>::LIMBS; ++i )
+    val.set_limb( i, test_rand() );
+  unsigned bits = 1 + test_rand() % Bits;
+  return bits == Bits ? val : val & ((UIntN<Bits>( 1 ) << bits) - UIntN<Bits>( 1 ));
+}
+
+TestObjs *setup() {
+  TestObjs *objs = new TestObjs;
+
+  objs->zero = U256();
+  objs->one = U256( 1 );
+  objs->max = ~U256();
+  objs->msb_set = U256( 1 ) << 255;
+
+  return objs;
+}
+
+void cleanup( TestObjs *objs ) {
+  delete objs;
+}
+
+void test_constexpr( TestObjs *objs ) {
+  // the static_asserts above did the real work; check the same
+  // constants at run time too
+  ASSERT( k_max == objs->max );
+  ASSERT( (k_p + U256( 19 )) == objs->msb_set );
+  constexpr U1024 big = U1024( 1 ) << 1000;
+  static_assert( big.bit_length() == 1001, "1024-bit constant" );
+  ASSERT( big.is_bit_set( 1000 ) );
+  ASSERT( !big.is_bit_set( 999 ) );
+}
+
+void test_interop( TestObjs *objs ) {
+  UInt256 c_max = uint256_create_from_hex( "ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" );
+  ASSERT( U256( c_max ) == objs->max );
+  ASSERT_SAME( c_max, objs->max.to_uint256() );
+
+  UInt256 c_val = uint256_create_from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f0" );
+  U256 val( c_val );
+  ASSERT( val.limb( 0 ) == 0x8796a5b4c3d2e1f0ULL );
+  ASSERT( val.limb( 3 ) == 0x0123456789abcdefULL );
+  ASSERT_SAME( c_val, val.to_uint256() );
+
+  // narrower types truncate, wider ones zero-extend
+  ASSERT( U128( c_val ) == U128::from_hex( "0f1e2d3c4b5a69788796a5b4c3d2e1f0" ) );
+  ASSERT_SAME( uint256_create_from_hex( "0f1e2d3c4b5a69788796a5b4c3d2e1f0" ), U128( c_val ).to_uint256() );
+  U512 wide( c_val );
+  ASSERT( wide.bit_length() == val.bit_length() );
+  ASSERT_SAME( c_val, wide.to_uint256() );
+  ASSERT_SAME( c_val, U512( val ).to_uint256() );
+}
+
+void test_add_sub( TestObjs *objs ) {
+  ASSERT( objs->max + objs->one == objs->zero );
+  ASSERT( objs->zero - objs->one == objs->max );
+  ASSERT( -objs->one == objs->max );
+  ASSERT( objs->msb_set + objs->msb_set == objs->zero );
+
+  // carry across every limb of a 1024-bit value
+  U1024 all = ~U1024();
+  ASSERT( all + U1024( 1 ) == U1024() );
+  ASSERT( U1024() - U1024( 1 ) == all );
+
+  U256 acc;
+  for ( uint64_t i = 1; i <= 100; ++i )
+    acc += U256( i );
+  ASSERT( acc == U256( 5050 ) );
+}
+
+void test_mul( TestObjs *objs ) {
+  ASSERT( objs->max * objs->max == objs->one );
+  ASSERT( objs->msb_set * U256( 2 ) == objs->zero );
+  ASSERT( U256( 0xffffffffffffffffULL ) * U256( 0xffffffffffffffffULL )
+          == U256::from_hex( "fffffffffffffffe0000000000000001" ) );
+
+  U512 sq = mul_wide( objs->max, objs->max );
+  ASSERT( sq == U512::from_hex( "fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffe"
+                                "0000000000000000000000000000000000000000000000000000000000000001" ) );
+}
+
+void test_shifts_bitwise( TestObjs *objs ) {
+  ASSERT( (objs->one << 255) == objs->msb_set );
+  ASSERT( (objs->msb_set >> 255) == objs->one );
+  ASSERT( (objs->max << 256) == objs->zero );
+  ASSERT( (objs->max >> 300) == objs->zero );
+  ASSERT( (objs->max >> 0) == objs->max );
+
+  U256 val = U256::from_hex( "0123456789abcdeffedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f0" );
+  ASSERT( (val >> 133) == U256::from_hex( "91a2b3c4d5e6f7ff6e5d4c3b2a190" ) );
+  ASSERT( (val << 64) == U256::from_hex( "fedcba98765432100f1e2d3c4b5a69788796a5b4c3d2e1f00000000000000000" ) );
+
+  U256 a = U256::from_hex( "ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00" );
+  U256 b = U256::from_hex( "f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0f0" );
+  ASSERT( (a & b) == U256::from_hex( "f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000f000" ) );
+  ASSERT( (a | b) == U256::from_hex( "fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0fff0" ) );
+  ASSERT( (a ^ b) == U256::from_hex( "0ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff0" ) );
+  ASSERT( ~a == U256::from_hex( "00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff00ff" ) );
+}
+
+void test_compare( TestObjs *objs ) {
+  ASSERT( objs->zero < objs->one );
+  ASSERT( objs->one <= objs->one );
+  ASSERT( objs->max > objs->msb_set );
+  ASSERT( objs->msb_set >= objs->one );
+  ASSERT( objs->one != objs->zero );
+  ASSERT( compare( objs->max, objs->max ) == 0 );
+  ASSERT( compare( objs->one, objs->msb_set ) < 0 );
+  ASSERT( !objs->zero );
+  ASSERT( bool( objs->msb_set ) );
+}
+
+void test_from_hex( TestObjs *objs ) {
+  ASSERT( U256::from_hex( "0" ) == objs->zero );
+  ASSERT( U256::from_hex( "" ) == objs->zero );
+  ASSERT( U256::from_hex( "FFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffffFFFFffff" ) == objs->max );
+  // only the rightmost 64 digits count
+  ASSERT( U256::from_hex( "123ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff" ) == objs->max );
+  ASSERT( U128::from_hex( "abcdef0123456789abcdef0123456789" ).limb( 1 ) == 0xabcdef0123456789ULL );
+  // digits stop at the first character that isn't one, as in C
+  ASSERT( U256::from_hex( "12g4" ) == U256::from_hex( "12" ) );
+  ASSERT( U256::from_hex( "1234\n" ) == U256::from_hex( "1234" ) );
+  ASSERT( U256::from_hex( "g1234" ) == objs->zero );
+  ASSERT_SAME( uint256_create_from_hex( "1234\n" ), U256::from_hex( "1234\n" ).to_uint256() );
+}
+
+void test_match_c_random( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int i = 0; i < 1000; ++i ) {
+    U256 a = random_operand<256>(), b = random_operand<256>();
+    UInt256 ca = a.to_uint256(), cb = b.to_uint256();
+    unsigned shift = test_rand() % 256;
+
+    ASSERT_SAME( uint256_add( ca, cb ), (a + b).to_uint256() );
+    ASSERT_SAME( uint256_sub( ca, cb ), (a - b).to_uint256() );
+    ASSERT_SAME( uint256_mul( ca, cb ), (a * b).to_uint256() );
+    ASSERT_SAME( uint256_negate( ca ), (-a).to_uint256() );
+    ASSERT_SAME( uint256_lshift( ca, shift ), (a << shift).to_uint256() );
+    ASSERT_SAME( uint256_rshift( ca, shift ), (a >> shift).to_uint256() );
+    ASSERT_SAME( uint256_xor( ca, cb ), (a ^ b).to_uint256() );
+    ASSERT( (uint256_cmp( ca, cb ) > 0) == (a > b) );
+    ASSERT( (uint256_cmp( ca, cb ) < 0) == (a < b) );
+
+    uint64_t den = test_rand() | 1, rem, c_rem;
+    ASSERT_SAME( uint256_divmod_u64( ca, den, &c_rem ), a.divmod_u64( den, &rem ).to_uint256() );
+    ASSERT( rem == c_rem );
+  }
+}
+
+void test_mul_wide_random( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int i = 0; i < 1000; ++i ) {
+    U256 a = random_operand<256>(), b = random_operand<256>();
+    UInt512 c = uint256_mul_wide( a.to_uint256(), b.to_uint256() );
+    U512 p = mul_wide( a, b );
+    ASSERT_SAME( uint512_lo( c ), U256( p ).to_uint256() );
+    ASSERT_SAME( uint512_hi( c ), U256( p >> 256 ).to_uint256() );
+
+    // the truncated product is the low half of the wide one
+    ASSERT( U512( a ) * U512( b ) == p );
+  }
+}
+
+void test_wide_identities( TestObjs *objs ) {
+  (void) objs;
+
+  for ( int i = 0; i < 200; ++i ) {
+    U1024 a = random_operand<1024>(), b = random_operand<1024>(), c = random_operand<1024>();
+    unsigned shift = test_rand() % 1024;
+
+    ASSERT( (a + b) - b == a );
+    ASSERT( a * (b + c) == a * b + a * c );
+    ASSERT( (a << shift) == a * (U1024( 1 ) << shift) );
+    ASSERT( ((a >> shift) << shift) == (a & ~((U1024( 1 ) << shift) - U1024( 1 ))) );
+
+    // q*d + r == a for single-limb division
+    uint64_t den = test_rand() | 1, rem;
+    U1024 q = a.divmod_u64( den, &rem );
+    ASSERT( q * U1024( den ) + U1024( rem ) == a );
+
+    // mul_wide agrees with the truncated product in the low half
+    U1024 lo( mul_wide( U512( a ), U512( b ) ) );
+    ASSERT( lo == U1024( U512( a ) ) * U1024( U512( b ) ) );
+  }
+}
+
+// One Karatsuba level over N limbs against schoolbook, for operands
+// that hit each sign of the (a0 - a1)(b0 - b1) middle term
+template<unsigned N>
+void check_karatsuba_level( const uint64_t *a, const uint64_t *b ) {
+  uint64_t expected[2 * N], actual[2 * N];
+  uintn_detail::mul_full_schoolbook<N>( expected, a, b );
+  uintn_detail::mul_full_karatsuba<N>( actual, a, b );
+  for ( unsigned i = 0; i < 2 * N; ++i )
+    ASSERT( expected[i] == actual[i] );
+}
+
+template<unsigned N>
+void check_karatsuba_sizes() {
+  uint64_t a[N], b[N];
+
+  // all ones (equal halves, so both differences are zero)
+  for ( unsigned i = 0; i < N; ++i )
+    a[i] = b[i] = ~0ULL;
+  check_karatsuba_level<N>( a, b );
+
+  // one half zero in each operand, both ways round
+  for ( unsigned i = 0; i < N; ++i ) {
+    a[i] = i < N / 2 ? ~0ULL : 0;
+    b[i] = i < N / 2 ? 0 : ~0ULL;
+  }
+  check_karatsuba_level<N>( a, b );
+  check_karatsuba_level<N>( b, a );
+  check_karatsuba_level<N>( a, a );
+
+  for ( int iter = 0; iter < 200; ++iter ) {
+    for ( unsigned i = 0; i < N; ++i ) {
+      a[i] = test_rand();
+      b[i] = test_rand();
+    }
+    // sometimes make the halves nearly equal
+    if ( iter % 4 == 0 )
+      a[N / 2] = a[0];
+    check_karatsuba_level<N>( a, b );
+  }
+}
+
+void test_karatsuba_small( TestObjs *objs ) {
+  (void) objs;
+  check_karatsuba_sizes<2>();
+  check_karatsuba_sizes<4>();
+  check_karatsuba_sizes<6>();
+  check_karatsuba_sizes<16>();
+}
+
+void test_karatsuba_wide( TestObjs *objs ) {
+  (void) objs;
+
+  // sizes at and above the threshold (up to two levels of recursion)
+  U2048 all2 = ~U2048();
+  uint64_t expected[128];
+  uintn_detail::mul_full_schoolbook<32>( expected, all2.limbs(), all2.limbs() );
+  U4096 sq = mul_wide( all2, all2 );
+  for ( unsigned i = 0; i < 64; ++i )
+    ASSERT( expected[i] == sq.limb( i ) );
+  ASSERT( all2 * all2 == U2048( 1 ) );
+
+  for ( int iter = 0; iter < 50; ++iter ) {
+    U2048 a = random_operand<2048>(), b = random_operand<2048>();
+    U4096 p = mul_wide( a, b );
+    uintn_detail::mul_full_schoolbook<32>( expected, a.limbs(), b.limbs() );
+    for ( unsigned i = 0; i < 64; ++i )
+      ASSERT( expected[i] == p.limb( i ) );
+    ASSERT( a * b == U2048( p ) );
+
+    U4096 x = random_operand<4096>(), y = random_operand<4096>();
+    uint64_t lo[64];
+    uintn_detail::mul_lo_schoolbook<64>( lo, x.limbs(), y.limbs() );
+    U4096 xy = x * y;
+    for ( unsigned i = 0; i < 64; ++i )
+      ASSERT( lo[i] == xy.limb( i ) );
+  }
+}
+
+void test_factorial( TestObjs *objs ) {
+  UIntNThreadPool pool( 3 );
+
+  UIntNProduct<256> f = uintn_factorial<256>( 0, pool );
+  ASSERT( f.exact && f.value == objs->one );
+  f = uintn_factorial<256>( 1, pool );
+  ASSERT( f.exact && f.value == objs->one );
+  f = uintn_factorial<256>( 20, pool );
+  ASSERT( f.exact && f.value == U256( 2432902008176640000ULL ) );
+
+  // 57! is the last factorial below 2^256
+  f = uintn_factorial<256>( 57, pool );
+  ASSERT( f.exact );
+  ASSERT( f.value == U256::from_hex( "59996c6ef58409a71b05be0bada2445eb7c017d09442e7d158e0000000000000" ) );
+  ASSERT_SAME( f.value.to_uint256(), f.low );
+  f = uintn_factorial<256>( 58, pool );
+  ASSERT( !f.exact );
+  ASSERT( U256( uintn_factorial<512>( 58, pool ).value ) == f.value );
+
+  // 1000! has 8530 bits; dividing the factors back out leaves 1
+  UIntNProduct<8704> big = uintn_factorial<8704>( 1000, pool );
+  ASSERT( big.exact );
+  ASSERT( big.value.bit_length() == 8530 );
+  UIntN<8704> q = big.value;
+  for ( uint64_t k = 1000; k >= 2; --k ) {
+    uint64_t rem;
+    q = q.divmod_u64( k, &rem );
+    ASSERT( rem == 0 );
+  }
+  ASSERT( q == UIntN<8704>( 1 ) );
+
+  // the low 256 bits match folding the factors with uint256_mul
+  UInt256 fold = uint256_create_from_u32( 1 );
+  for ( uint32_t k = 2; k <= 1000; ++k )
+    fold = uint256_mul( fold, uint256_create_from_u32( k ) );
+  ASSERT_SAME( fold, big.low );
+  ASSERT_SAME( fold, uintn_factorial<256>( 1000, pool ).low );
+
+  // the default pool, and a range that is empty
+  ASSERT( uintn_factorial<8704>( 1000 ).value == big.value );
+  f = uintn_range_product<256>( 5, 4, pool );
+  ASSERT( f.exact && f.value == objs->one );
+  f = uintn_range_product<256>( 0, 100, pool );
+  ASSERT( f.exact && f.value == objs->zero );
+
+  // 2^320 wraps to zero, which isn't exact unless a factor is zero
+  uint64_t twos[6] = { 1ULL << 63, 1ULL << 63, 1ULL << 63, 1ULL << 63, 1ULL << 63, 1ULL << 5 };
+  f = uintn_product<256>( twos, 6, pool );
+  ASSERT( !f.exact && f.value == objs->zero );
+  twos[5] = 0;
+  f = uintn_product<256>( twos, 6, pool );
+  ASSERT( f.exact && f.value == objs->zero );
+}
+
+void test_product_random( TestObjs *objs ) {
+  (void) objs;
+  UIntNThreadPool pools[] = { UIntNThreadPool( 1 ), UIntNThreadPool( 2 ), UIntNThreadPool( 5 ) };
+  uint64_t factors[130];
+
+  for ( int iter = 0; iter < 40; ++iter ) {
+    // up to about twice the 4096-bit width, so both exact and
+    // wrapped products (and both join methods) come up
+    size_t n = test_rand() % 130;
+    for ( size_t i = 0; i < n; ++i )
+      factors[i] = test_rand() >> (test_rand() % 4 == 0 ? test_rand() % 64 : 0);
+    if ( iter == 7 )
+      factors[n / 2] = 0;
+
+    U4096 wrapped( 1 );
+    U8192 exact( 1 );
+    UInt256 low = uint256_create_from_u32( 1 );
+    for ( size_t i = 0; i < n; ++i ) {
+      wrapped *= U4096( factors[i] );
+      exact *= U8192( factors[i] );
+      low = uint256_mul( low, U256( factors[i] ).to_uint256() );
+    }
+
+    for ( UIntNThreadPool &pool : pools ) {
+      UIntNProduct<4096> p = uintn_product<4096>( factors, n, pool );
+      ASSERT( p.value == wrapped );
+      ASSERT( p.exact == (exact.bit_length() <= 4096) );
+      ASSERT_SAME( low, p.low );
+    }
+  }
+}
+
+void test_product_concurrent( TestObjs *objs ) {
+  (void) objs;
+  UIntNThreadPool pool( 4 );
+  UIntN<8704> expected = uintn_factorial<8704>( 1000, pool ).value;
+
+  // several threads sharing one pool (and the default one); the
+  // checks run here, since a failed ASSERT can't unwind another thread
+  const int NTHREADS = 4, ROUNDS = 200;
+  int bad[NTHREADS] = { 0 };
+  std::thread threads[NTHREADS];
+  for ( int t = 0; t < NTHREADS; ++t ) {
+    threads[t] = std::thread( [&, t] {
+      for ( int r = 0; r < ROUNDS; ++r ) {
+        UIntNProduct<8704> p = (t % 2) ? uintn_factorial<8704>( 1000 ) : uintn_factorial<8704>( 1000, pool );
+        bad[t] += !p.exact || !(p.value == expected);
+      }
+    } );
+  }
+  for ( int t = 0; t < NTHREADS; ++t ) {
+    threads[t].join();
+    ASSERT( bad[t] == 0 );
+  }
+}